@@ -0,0 +1,383 @@
+#ifndef _ALLOCATORS_H_
+#define _ALLOCATORS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace epl{
+    
+    // Monotonic arena.  Allocation bumps a pointer through a chain of blocks
+    // and individual deallocation is a no-op; everything handed out is given
+    // back at once by release() or by destroying the arena.  Not thread safe.
+    class arena {
+    private:
+        struct block {
+            block* next;
+            size_t size;
+        };
+        
+        block* blocks = nullptr;
+        char* cursor = nullptr;
+        char* limit = nullptr;
+        
+        char* initial_buffer;
+        size_t initial_size;
+        size_t block_size;
+    
+    public:
+        explicit arena(size_t block_size = 64 * 1024) :
+        initial_buffer(nullptr), initial_size(0), block_size(block_size) {
+        }
+        
+        // carve allocations out of caller-owned memory (e.g. a stack buffer)
+        // before falling back to the heap
+        arena(void* buffer, size_t size) :
+        cursor(static_cast<char*>(buffer)), limit(static_cast<char*>(buffer) + size),
+        initial_buffer(static_cast<char*>(buffer)), initial_size(size), block_size(size < 4096 ? 4096 : size) {
+        }
+        
+        arena(const arena&) = delete;
+        arena& operator=(const arena&) = delete;
+        
+        ~arena(void) {
+            free_blocks();
+        }
+        
+        void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+            char* p = align_up(cursor, alignment);
+            if (cursor == nullptr || p + bytes > limit) {
+                grow(bytes + alignment);
+                p = align_up(cursor, alignment);
+            }
+            cursor = p + bytes;
+            return p;
+        }
+        
+        void deallocate(void*, size_t) {
+        }
+        
+        // invalidates everything allocated from the arena; the cost depends
+        // only on the number of heap blocks, not on the number of allocations.
+        // Without a caller buffer the newest block is kept for reuse.
+        void release(void) {
+            if (initial_buffer == nullptr && blocks != nullptr) {
+                block* keep = blocks;
+                blocks = blocks->next;
+                free_blocks();
+                keep->next = nullptr;
+                blocks = keep;
+                cursor = reinterpret_cast<char*>(keep + 1);
+                limit = reinterpret_cast<char*>(keep) + keep->size;
+                return;
+            }
+            free_blocks();
+            cursor = initial_buffer;
+            limit = initial_buffer + initial_size;
+        }
+    
+    private:
+        static char* align_up(char* p, size_t alignment) {
+            uintptr_t bits = reinterpret_cast<uintptr_t>(p);
+            return reinterpret_cast<char*>((bits + alignment - 1) & ~(uintptr_t) (alignment - 1));
+        }
+        
+        void grow(size_t bytes) {
+            size_t size = block_size;
+            while (size < bytes + sizeof(block)) { size *= 2; }
+            
+            block* b = static_cast<block*>(operator new(size));
+            b->next = blocks;
+            b->size = size;
+            blocks = b;
+            cursor = reinterpret_cast<char*>(b + 1);
+            limit = reinterpret_cast<char*>(b) + size;
+        }
+        
+        void free_blocks(void) {
+            while (blocks != nullptr) {
+                block* next = blocks->next;
+                operator delete(blocks);
+                blocks = next;
+            }
+        }
+    };
+    
+    // Size-class pool.  Requests are rounded up to a power of two and served
+    // from a free list per class, refilled from large slabs, so the
+    // allocate/free pattern of a growing vector recycles the same blocks.
+    // Requests larger than the biggest class go straight to operator new.
+    // Not thread safe.
+    class pool {
+    private:
+        static const size_t min_class_shift = 4; // 16 bytes
+        static const size_t num_classes = 13;    // up to 64 KiB
+        static const size_t slab_size = 256 * 1024;
+        
+        struct free_node {
+            free_node* next;
+        };
+        
+        struct slab {
+            slab* next;
+        };
+        
+        free_node* free_lists[num_classes] = {};
+        slab* slabs = nullptr;
+        char* cursor = nullptr;
+        char* limit = nullptr;
+    
+    public:
+        pool(void) {}
+        
+        pool(const pool&) = delete;
+        pool& operator=(const pool&) = delete;
+        
+        ~pool(void) {
+            release();
+        }
+        
+        static size_t max_pooled_size(void) { return size_t(1) << (min_class_shift + num_classes - 1); }
+        
+        void* allocate(size_t bytes) {
+            if (bytes > max_pooled_size()) { return operator new(bytes); }
+            size_t c = size_class(bytes);
+            free_node* node = free_lists[c];
+            if (node != nullptr) {
+                free_lists[c] = node->next;
+                return node;
+            }
+            size_t size = size_t(1) << (c + min_class_shift);
+            if (cursor == nullptr || cursor + size > limit) { new_slab(); }
+            void* p = cursor;
+            cursor += size;
+            return p;
+        }
+        
+        void deallocate(void* p, size_t bytes) {
+            if (bytes > max_pooled_size()) {
+                operator delete(p);
+                return;
+            }
+            size_t c = size_class(bytes);
+            free_node* node = static_cast<free_node*>(p);
+            node->next = free_lists[c];
+            free_lists[c] = node;
+        }
+        
+        // returns every slab to the heap at once; outstanding pooled
+        // allocations become invalid (oversized ones are not tracked)
+        void release(void) {
+            while (slabs != nullptr) {
+                slab* next = slabs->next;
+                operator delete(slabs);
+                slabs = next;
+            }
+            for (size_t c = 0; c < num_classes; c += 1) { free_lists[c] = nullptr; }
+            cursor = limit = nullptr;
+        }
+    
+    private:
+        static size_t size_class(size_t bytes) {
+            size_t c = 0;
+            size_t size = size_t(1) << min_class_shift;
+            while (size < bytes) {
+                size *= 2;
+                ++c;
+            }
+            return c;
+        }
+        
+        void new_slab(void) {
+            // slab headers are padded so that every block stays 16-byte aligned
+            const size_t header = (sizeof(slab) + 15) & ~size_t(15);
+            slab* s = static_cast<slab*>(operator new(slab_size + header));
+            s->next = slabs;
+            slabs = s;
+            cursor = reinterpret_cast<char*>(s) + header;
+            limit = cursor + slab_size;
+        }
+    };
+    
+    // Allocator handles over the resources above.  They are stateful: two
+    // allocators compare equal only when they draw from the same resource,
+    // and a vector moved into another takes its allocator along so that the
+    // buffer can be stolen instead of copied.
+    template <typename T>
+    class arena_allocator {
+    public:
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+        using is_always_equal = std::false_type;
+        
+        arena* resource;
+        
+        arena_allocator(arena& resource) : resource(&resource) {}
+        
+        template <typename U>
+        arena_allocator(const arena_allocator<U>& that) : resource(that.resource) {}
+        
+        T* allocate(size_t n) { return static_cast<T*>(resource->allocate(n * sizeof(T), alignof(T))); }
+        void deallocate(T* p, size_t n) { resource->deallocate(p, n * sizeof(T)); }
+        
+        template <typename U>
+        bool operator==(const arena_allocator<U>& that) const { return resource == that.resource; }
+        template <typename U>
+        bool operator!=(const arena_allocator<U>& that) const { return resource != that.resource; }
+    };
+    
+    template <typename T>
+    class pool_allocator {
+    public:
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+        using is_always_equal = std::false_type;
+        
+        pool* resource;
+        
+        pool_allocator(pool& resource) : resource(&resource) {}
+        
+        template <typename U>
+        pool_allocator(const pool_allocator<U>& that) : resource(that.resource) {}
+        
+        T* allocate(size_t n) {
+            static_assert(alignof(T) <= 16, "pool blocks are only 16-byte aligned");
+            return static_cast<T*>(resource->allocate(n * sizeof(T)));
+        }
+        void deallocate(T* p, size_t n) { resource->deallocate(p, n * sizeof(T)); }
+        
+        template <typename U>
+        bool operator==(const pool_allocator<U>& that) const { return resource == that.resource; }
+        template <typename U>
+        bool operator!=(const pool_allocator<U>& that) const { return resource != that.resource; }
+    };
+    
+    // Storage for very large vectors.  Blocks of at least Threshold bytes are
+    // mapped directly with mmap, rounded to 2 MiB so that they can be backed
+    // by huge pages: explicit MAP_HUGETLB pages when the system has some
+    // reserved, transparent huge pages (MADV_HUGEPAGE) otherwise.  Smaller
+    // blocks come from operator new.
+    //
+    // Mapped blocks support the optional vector hooks: reallocate() grows
+    // them with mremap, so the kernel moves page table entries instead of
+    // the vector copying elements, and discard() releases the pages behind
+    // unused capacity with MADV_DONTNEED.  On other systems everything goes
+    // through operator new and the hooks report that they cannot help.
+    template <typename T, std::size_t Threshold = (std::size_t(1) << 21)>
+    class mmap_allocator {
+    public:
+        using value_type = T;
+        using is_always_equal = std::true_type;
+        
+        template <typename U> struct rebind { typedef mmap_allocator<U, Threshold> other; };
+        
+        static const std::size_t huge_page_size = std::size_t(1) << 21;
+        
+        mmap_allocator(void) {}
+        
+        template <typename U>
+        mmap_allocator(const mmap_allocator<U, Threshold>&) {}
+        
+        T* allocate(size_t n) {
+            size_t bytes = n * sizeof(T);
+            if (!is_mapped(bytes)) { return static_cast<T*>(operator new(bytes)); }
+            void* p = map(mapped_length(bytes));
+            if (p == nullptr) { throw std::bad_alloc(); }
+            return static_cast<T*>(p);
+        }
+        
+        void deallocate(T* p, size_t n) {
+            size_t bytes = n * sizeof(T);
+            if (!is_mapped(bytes)) {
+                operator delete(p);
+                return;
+            }
+#ifdef __linux__
+            munmap(p, mapped_length(bytes));
+#endif
+        }
+        
+        T* reallocate(T* p, size_t old_n, size_t new_n) {
+#ifdef __linux__
+            size_t old_bytes = old_n * sizeof(T);
+            size_t new_bytes = new_n * sizeof(T);
+            if (!is_mapped(old_bytes) || !is_mapped(new_bytes)) { return nullptr; }
+            void* q = mremap(p, mapped_length(old_bytes), mapped_length(new_bytes), MREMAP_MAYMOVE);
+            if (q == MAP_FAILED) { return nullptr; } // e.g. a MAP_HUGETLB block the kernel will not resize
+            advise_huge(q, mapped_length(new_bytes));
+            return static_cast<T*>(q);
+#else
+            (void) p; (void) old_n; (void) new_n;
+            return nullptr;
+#endif
+        }
+        
+        void discard(T* p, size_t n) {
+#ifdef __linux__
+            uintptr_t page = (uintptr_t) sysconf(_SC_PAGESIZE);
+            uintptr_t first = (reinterpret_cast<uintptr_t>(p) + page - 1) & ~(page - 1);
+            uintptr_t last = (reinterpret_cast<uintptr_t>(p + n)) & ~(page - 1);
+            if (first < last) { madvise(reinterpret_cast<void*>(first), last - first, MADV_DONTNEED); }
+#else
+            (void) p; (void) n;
+#endif
+        }
+        
+        template <typename U>
+        bool operator==(const mmap_allocator<U, Threshold>&) const { return true; }
+        template <typename U>
+        bool operator!=(const mmap_allocator<U, Threshold>&) const { return false; }
+        
+    private:
+        static bool is_mapped(size_t bytes) {
+#ifdef __linux__
+            return bytes >= Threshold;
+#else
+            (void) bytes;
+            return false;
+#endif
+        }
+        
+        static size_t mapped_length(size_t bytes) {
+            return (bytes + huge_page_size - 1) & ~(huge_page_size - 1);
+        }
+        
+        static void* map(size_t length) {
+#ifdef __linux__
+            void* p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+            p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED) { return p; }
+#endif
+            p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED) { return nullptr; }
+            advise_huge(p, length);
+            return p;
+#else
+            (void) length;
+            return nullptr;
+#endif
+        }
+        
+        static void advise_huge(void* p, size_t length) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+            madvise(p, length, MADV_HUGEPAGE); // best effort; THP may be disabled
+#else
+            (void) p; (void) length;
+#endif
+        }
+    };
+    
+} //namespace epl
+
+#endif
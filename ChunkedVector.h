@@ -0,0 +1,438 @@
+#ifndef _CHUNKED_VECTOR_H_
+#define _CHUNKED_VECTOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "Vector.h"
+
+namespace epl{
+    
+    namespace detail {
+        constexpr uint64_t floor_pow2(uint64_t n) { return n < 2 ? 1 : 2 * floor_pow2(n / 2); }
+        
+        // The version counters behind chunked_vector's checked iterators,
+        // held by the container and by each iterator.  Unchecked, they are
+        // empty and every comparison says nothing has changed.
+        template <bool Enabled>
+        struct chunk_versions {
+            size_t version = 0;
+            size_t resize_version = 0;
+            
+            void modified(void) { ++version; }
+            void resized(void) { ++resize_version; }
+            bool same(const chunk_versions& that) const { return version == that.version && resize_version == that.resize_version; }
+            bool same_buffer(const chunk_versions& that) const { return resize_version == that.resize_version; }
+        };
+        
+        template <>
+        struct chunk_versions<false> {
+            void modified(void) {}
+            void resized(void) {}
+            bool same(const chunk_versions&) const { return true; }
+            bool same_buffer(const chunk_versions&) const { return true; }
+        };
+    }
+    
+    // Double-ended container that stores its elements in fixed-size blocks
+    // (about 4KiB each) reached through a block map, so growth at either end
+    // allocates a block and never moves an element.  push_front/push_back are
+    // O(1) apart from the block map itself, an epl::vector of one pointer per
+    // block that grows amortized.  Indexing is O(1): a shift, a mask and
+    // two loads.
+    //
+    // Iterators are checked with a version and a resize_version but only
+    // structural changes count: push_front/push_back leave every iterator
+    // valid, pop_front/pop_back/clear bump version, and assignment bumps
+    // resize_version.  An iterator names an element by its distance from a
+    // fixed origin, so it keeps pointing at the same element when elements
+    // are added in front of it.  Unchecked containers and iterators carry no
+    // versions at all.
+    template <typename T, typename Checking = default_checking, typename Alloc = std::allocator<T>>
+    class chunked_vector : private detail::chunk_versions<Checking::enabled> {
+    private:
+        using versions = detail::chunk_versions<Checking::enabled>;
+        using versions::modified;
+        using versions::resized;
+        using alloc_traits = std::allocator_traits<Alloc>;
+        using map_type = vector<T*, unchecked, typename alloc_traits::template rebind_alloc<T*>>;
+        
+        Alloc alloc;
+        
+        map_type blocks;
+        T* spare = nullptr;   // the last freed block, kept so that push/pop at a block edge does not thrash
+        uint64_t head = 0;    // offset of the first element in blocks[0]
+        uint64_t count = 0;
+        int64_t origin = 0;   // position of the first element, for iterators
+    
+    public:
+        // a power of two, so that indexing compiles to a shift and a mask
+        static const uint64_t block_size = sizeof(T) > 256 ? 16 : detail::floor_pow2(4096 / sizeof(T));
+        
+        using value_type = T;
+        using reference = T&;
+        using const_reference = const T&;
+        using size_type = uint64_t;
+        using difference_type = std::ptrdiff_t;
+        using allocator_type = Alloc;
+        
+        chunked_vector(void) : chunked_vector(Alloc()) {
+        }
+        
+        explicit chunked_vector(const Alloc& alloc) : alloc(alloc), blocks(typename map_type::allocator_type(alloc)) {
+        }
+        
+        explicit chunked_vector(uint64_t n, const Alloc& alloc = Alloc()) : chunked_vector(alloc) {
+            for (uint64_t k = 0; k < n; k += 1) { emplace_back(); }
+        }
+        
+        template <typename Iterator, typename = typename std::iterator_traits<Iterator>::iterator_category>
+        chunked_vector(Iterator first, Iterator last, const Alloc& alloc = Alloc()) : chunked_vector(alloc) {
+            for (; first != last; ++first) { emplace_back(*first); }
+        }
+        
+        chunked_vector(std::initializer_list<T> il, const Alloc& alloc = Alloc()) :
+        chunked_vector(il.begin(), il.end(), alloc) {
+        }
+        
+        chunked_vector(const chunked_vector& that) : chunked_vector(alloc_traits::select_on_container_copy_construction(that.alloc)) {
+            for (uint64_t k = 0; k < that.size(); k += 1) { emplace_back(that[k]); }
+        }
+        
+        chunked_vector(chunked_vector&& that) : alloc(std::move(that.alloc)), blocks(std::move(that.blocks)) {
+            take(that);
+        }
+        
+        ~chunked_vector(void) {
+            destroy();
+        }
+        
+        chunked_vector& operator=(const chunked_vector& rhs) {
+            if (this != &rhs) {
+                clear();
+                for (uint64_t k = 0; k < rhs.size(); k += 1) { emplace_back(rhs[k]); }
+                resized();
+            }
+            return *this;
+        }
+        
+        // blocks are handed over only when the allocators can free each other's memory
+        chunked_vector& operator=(chunked_vector&& rhs) {
+            if (this == &rhs) { return *this; }
+            if (alloc_traits::propagate_on_container_move_assignment::value || alloc == rhs.alloc) {
+                destroy();
+                if (alloc_traits::propagate_on_container_move_assignment::value) { alloc = std::move(rhs.alloc); }
+                blocks = std::move(rhs.blocks);
+                take(rhs);
+            } else {
+                clear();
+                for (uint64_t k = 0; k < rhs.size(); k += 1) { emplace_back(std::move(rhs[k])); }
+                rhs.clear();
+            }
+            modified();
+            resized();
+            return *this;
+        }
+        
+        Alloc get_allocator(void) const {
+            return alloc;
+        }
+        
+        uint64_t size(void) const {
+            return count;
+        }
+        
+        T& operator[](uint64_t k) {
+            if (k >= count) { throw std::out_of_range("index out of range"); }
+            return *slot(k);
+        }
+        
+        const T& operator[](uint64_t k) const {
+            if (k >= count) { throw std::out_of_range("index out of range"); }
+            return *slot(k);
+        }
+        
+        void push_back(const T& that) { emplace_back(that); }
+        void push_back(T&& that) { emplace_back(std::move(that)); }
+        
+        template <typename... Args>
+        void emplace_back(Args&&... args) {
+            const bool grow = head + count == blocks.size() * block_size;
+            if (grow) { link_back(make_block()); }
+            try {
+                alloc_traits::construct(alloc, slot(count), std::forward<Args>(args)...);
+            } catch (...) {
+                if (grow) { free_block(blocks.back()); blocks.pop_back(); }
+                throw;
+            }
+            ++count;
+        }
+        
+        void push_front(const T& that) { emplace_front(that); }
+        void push_front(T&& that) { emplace_front(std::move(that)); }
+        
+        template <typename... Args>
+        void emplace_front(Args&&... args) {
+            const bool grow = head == 0;
+            if (grow) {
+                link_front(make_block());
+                head = block_size;
+            }
+            try {
+                alloc_traits::construct(alloc, blocks.data()[0] + head - 1, std::forward<Args>(args)...);
+            } catch (...) {
+                if (grow) { free_block(blocks.front()); blocks.pop_front(); head = 0; }
+                throw;
+            }
+            --head;
+            ++count;
+            --origin;
+        }
+        
+        void pop_back(void) {
+            modified();
+            if (count == 0) { throw std::out_of_range("empty vector, nothing to pop back"); }
+            --count;
+            alloc_traits::destroy(alloc, slot(count));
+            if ((head + count) % block_size == 0) {
+                free_block(blocks.back());
+                blocks.pop_back();
+                if (blocks.size() == 0) { head = 0; }
+            }
+        }
+        
+        void pop_front(void) {
+            modified();
+            if (count == 0) { throw std::out_of_range("empty vector, nothing to pop front"); }
+            alloc_traits::destroy(alloc, slot(0));
+            ++head;
+            --count;
+            ++origin;
+            if (head == block_size || count == 0) {
+                free_block(blocks.front());
+                blocks.pop_front();
+                head = 0;
+            }
+        }
+        
+        T& front(void) {
+            if (count == 0) { throw std::out_of_range("empty Vector"); }
+            return *slot(0);
+        }
+        
+        const T& front(void) const {
+            if (count == 0) { throw std::out_of_range("empty Vector"); }
+            return *slot(0);
+        }
+        
+        T& back(void) {
+            if (count == 0) { throw std::out_of_range("back called on empty Vector"); }
+            return *slot(count - 1);
+        }
+        
+        const T& back(void) const {
+            if (count == 0) { throw std::out_of_range("back called on empty Vector"); }
+            return *slot(count - 1);
+        }
+        
+        void clear(void) {
+            while (count != 0) {
+                --count;
+                alloc_traits::destroy(alloc, slot(count));
+            }
+            while (blocks.size() != 0) {
+                free_block(blocks.back());
+                blocks.pop_back();
+            }
+            head = 0;
+            origin = 0;
+            modified();
+        }
+        
+        /*****************************************************************************************/
+        // Iterators
+        /*****************************************************************************************/
+        template <bool Const>
+        class basic_iterator : private versions {
+            using container = typename std::conditional<Const, const chunked_vector, chunked_vector>::type;
+            
+            container* obj;
+            
+            int64_t position; // distance from the container's origin
+            bool valid;
+        
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = typename std::conditional<Const, const T*, T*>::type;
+            using reference = typename std::conditional<Const, const T&, T&>::type;
+            
+            basic_iterator(void) : obj(nullptr), position(0), valid(true) {}
+            
+            template <bool C = Const, typename = typename std::enable_if<C>::type>
+            basic_iterator(const basic_iterator<false>& that) :
+            versions(that), obj(that.obj), position(that.position), valid(that.valid) {}
+            
+            reference operator*(void) const {
+                validate(this);
+                return *obj->slot(position - obj->origin);
+            }
+            
+            pointer operator->(void) const { return &**this; }
+            
+            reference operator[](difference_type k) const { return *(*this + k); }
+            
+            basic_iterator& operator++(void) { return *this += 1; }
+            basic_iterator operator++(int) { basic_iterator tmp(*this); *this += 1; return tmp; }
+            basic_iterator& operator--(void) { return *this -= 1; }
+            basic_iterator operator--(int) { basic_iterator tmp(*this); *this -= 1; return tmp; }
+            
+            basic_iterator& operator+=(difference_type k) {
+                validate(this);
+                position += k;
+                valid = in_range();
+                return *this;
+            }
+            
+            basic_iterator& operator-=(difference_type k) { return *this += -k; }
+            basic_iterator operator+(difference_type k) const { basic_iterator tmp(*this); return tmp += k; }
+            basic_iterator operator-(difference_type k) const { basic_iterator tmp(*this); return tmp -= k; }
+            friend basic_iterator operator+(difference_type k, const basic_iterator& it) { return it + k; }
+            
+            difference_type operator-(const basic_iterator& that) const {
+                validate(this);
+                validate(&that);
+                return position - that.position;
+            }
+            
+            bool operator==(const basic_iterator& that) const {
+                validate(this);
+                validate(&that);
+                return position == that.position;
+            }
+            
+            bool operator!=(const basic_iterator& that) const { return ! (*this == that); }
+            
+            bool operator<(const basic_iterator& that) const {
+                validate(this);
+                validate(&that);
+                return position < that.position;
+            }
+            
+            bool operator>(const basic_iterator& that) const { return that < *this; }
+            bool operator<=(const basic_iterator& that) const { return ! (that < *this); }
+            bool operator>=(const basic_iterator& that) const { return ! (*this < that); }
+            
+            friend chunked_vector;
+            friend class basic_iterator<true>;
+        
+        private:
+            basic_iterator(container* obj, int64_t position) :
+            versions(*obj), obj(obj), position(position), valid(false) {
+                valid = in_range();
+            }
+            
+            bool in_range(void) const {
+                return position >= obj->origin && position < obj->origin + (int64_t) obj->count;
+            }
+            
+            // same severities as the vector's iterators; only pops, clear and
+            // assignment change the versions
+            void validate(const basic_iterator* iter) const {
+                if (! Checking::enabled) { return; }
+                const versions& current = *iter->obj;
+                if (! iter->same(current)) {
+                    invalid_iterator::SeverityLevel level;
+                    if (iter->valid && ! iter->in_range())
+                    { level = epl::invalid_iterator::SEVERE; }
+                    else if (iter->valid && ! iter->same_buffer(current))
+                    { level = epl::invalid_iterator::MODERATE; }
+                    else
+                    { level = epl::invalid_iterator::MILD; }
+                    throw epl::invalid_iterator{ level };
+                }
+            }
+        };
+        
+        using iterator = basic_iterator<false>;
+        using const_iterator = basic_iterator<true>;
+        
+        iterator begin(void) { return iterator(this, origin); }
+        iterator end(void) { return iterator(this, origin + (int64_t) count); }
+        const_iterator begin(void) const { return const_iterator(this, origin); }
+        const_iterator end(void) const { return const_iterator(this, origin + (int64_t) count); }
+        const_iterator cbegin(void) const { return begin(); }
+        const_iterator cend(void) const { return end(); }
+    
+    private:
+        T* slot(uint64_t k) const {
+            const uint64_t p = head + k;
+            return blocks.data()[p / block_size] + p % block_size;
+        }
+        
+        T* make_block(void) {
+            if (spare != nullptr) {
+                T* p = spare;
+                spare = nullptr;
+                return p;
+            }
+            return alloc_traits::allocate(alloc, block_size);
+        }
+        
+        void free_block(T* p) {
+            if (spare == nullptr) {
+                spare = p;
+            } else {
+                alloc_traits::deallocate(alloc, p, block_size);
+            }
+        }
+        
+        // growing the map may throw; the block is not lost if it does
+        void link_back(T* p) {
+            try {
+                blocks.push_back(p);
+            } catch (...) {
+                free_block(p);
+                throw;
+            }
+        }
+        
+        void link_front(T* p) {
+            try {
+                blocks.push_front(p);
+            } catch (...) {
+                free_block(p);
+                throw;
+            }
+        }
+        
+        void destroy(void) {
+            clear();
+            if (spare != nullptr) {
+                alloc_traits::deallocate(alloc, spare, block_size);
+                spare = nullptr;
+            }
+        }
+        
+        // takes that's elements; blocks has already been moved from that
+        void take(chunked_vector& that) {
+            head = that.head;
+            count = that.count;
+            origin = that.origin;
+            that.head = that.count = 0;
+            that.origin = 0;
+            that.modified();
+            that.resized();
+        }
+    };
+    
+} //namespace epl
+
+#endif
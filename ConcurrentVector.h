@@ -0,0 +1,299 @@
+#ifndef _CONCURRENT_VECTOR_H_
+#define _CONCURRENT_VECTOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace epl{
+    
+    // Grow-only vector that any number of threads may push_back to and read
+    // from at the same time, without locks.
+    //
+    // Elements live in buckets of 8, 16, 32, ... elements that are allocated
+    // on demand and never moved, so references, pointers and iterators stay
+    // valid until clear() or destruction.  A push makes sure the bucket for
+    // the next index exists, reserves that index with a compare-and-swap,
+    // constructs the element in place and marks it ready; size() is the
+    // length of the ready prefix, which the pushing threads advance for each
+    // other.  Everything below size() may be read by any thread.  A bucket
+    // allocation that throws therefore leaves no reserved slot behind.
+    //
+    // If a constructor throws, its slot stays empty: it counts towards size()
+    // but is skipped by the destructor, and at() reports it.  operator[] and
+    // the iterators do not check, so with a type whose constructor can throw
+    // read the elements through at().
+    template <typename T, typename Alloc = std::allocator<T>>
+    class concurrent_vector {
+        using alloc_traits = std::allocator_traits<Alloc>;
+        
+        enum slot_state : uint8_t { PENDING, READY, FAILED };
+        
+        struct bucket {
+            T* slots;
+            std::atomic<uint8_t>* states;
+        };
+        
+        static const uint64_t first_bucket_bits = 3;
+        static const uint64_t bucket_count = 64 - first_bucket_bits;
+        
+        Alloc alloc;
+        std::atomic<bucket*> buckets[bucket_count];
+        std::atomic<uint64_t> reserved;
+        std::atomic<uint64_t> published;
+    
+    public:
+        using value_type = T;
+        using allocator_type = Alloc;
+        using size_type = uint64_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = T&;
+        using const_reference = const T&;
+        
+        explicit concurrent_vector(const Alloc& alloc = Alloc()) : alloc(alloc), reserved(0), published(0) {
+            for (uint64_t b = 0; b < bucket_count; ++b) { buckets[b].store(nullptr, std::memory_order_relaxed); }
+        }
+        
+        concurrent_vector(const concurrent_vector&) = delete;
+        concurrent_vector& operator=(const concurrent_vector&) = delete;
+        
+        ~concurrent_vector(void) {
+            clear();
+            for (uint64_t b = 0; b < bucket_count; ++b) {
+                free_bucket(b, buckets[b].load(std::memory_order_relaxed));
+            }
+        }
+        
+        /*****************************************************************************************/
+        // Thread-safe
+        /*****************************************************************************************/
+        // returns the index of the new element
+        template <typename... Args>
+        uint64_t emplace_back(Args&&... args) {
+            uint64_t index = reserved.load();
+            uint64_t b;
+            bucket* bk;
+            do {
+                b = bucket_of(index);
+                bk = get_bucket(b);
+            } while (! reserved.compare_exchange_weak(index, index + 1));
+            const uint64_t k = index - bucket_start(b);
+            try {
+                alloc_traits::construct(alloc, bk->slots + k, std::forward<Args>(args)...);
+            } catch (...) {
+                bk->states[k].store(FAILED);
+                publish();
+                throw;
+            }
+            bk->states[k].store(READY);
+            publish();
+            return index;
+        }
+        
+        uint64_t push_back(const T& v) { return emplace_back(v); }
+        uint64_t push_back(T&& v) { return emplace_back(std::move(v)); }
+        
+        // allocates buckets up front so that the first n pushes never allocate
+        void reserve(uint64_t n) {
+            for (uint64_t b = 0; n != 0 && b <= bucket_of(n - 1); ++b) { get_bucket(b); }
+        }
+        
+        T& operator[](uint64_t k) { return *slot(k); }
+        const T& operator[](uint64_t k) const { return *slot(k); }
+        
+        T& at(uint64_t k) { return *checked_slot(k); }
+        const T& at(uint64_t k) const { return *checked_slot(k); }
+        
+        // elements [0, size()) are constructed and visible to the caller
+        uint64_t size(void) const { return published.load(std::memory_order_acquire); }
+        bool empty(void) const { return size() == 0; }
+        
+        // slots in the buckets allocated so far
+        uint64_t capacity(void) const {
+            uint64_t n = 0;
+            for (uint64_t b = 0; b < bucket_count && buckets[b].load(std::memory_order_acquire) != nullptr; ++b) {
+                n += bucket_size(b);
+            }
+            return n;
+        }
+        
+        allocator_type get_allocator(void) const { return alloc; }
+        
+        /*****************************************************************************************/
+        // Not thread-safe
+        /*****************************************************************************************/
+        // destroys the elements and keeps the buckets
+        void clear(void) {
+            const uint64_t n = reserved.load(std::memory_order_acquire);
+            for (uint64_t k = 0; k < n; ++k) {
+                const uint64_t b = bucket_of(k);
+                bucket* bk = buckets[b].load(std::memory_order_relaxed);
+                std::atomic<uint8_t>& state = bk->states[k - bucket_start(b)];
+                if (state.load(std::memory_order_relaxed) == READY) {
+                    alloc_traits::destroy(alloc, bk->slots + (k - bucket_start(b)));
+                }
+                state.store(PENDING, std::memory_order_relaxed);
+            }
+            reserved.store(0, std::memory_order_relaxed);
+            published.store(0, std::memory_order_relaxed);
+        }
+        
+        /*****************************************************************************************/
+        // Iterators
+        /*****************************************************************************************/
+        // A random-access iterator over element indices.  end() is taken
+        // from size() when it is called; later pushes are not part of the
+        // range but never invalidate it.
+        template <bool Const>
+        class basic_iterator {
+            using container = typename std::conditional<Const, const concurrent_vector, concurrent_vector>::type;
+            
+            container* obj;
+            uint64_t index;
+        
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = typename std::conditional<Const, const T*, T*>::type;
+            using reference = typename std::conditional<Const, const T&, T&>::type;
+            
+            basic_iterator(void) : obj(nullptr), index(0) {}
+            basic_iterator(container* obj, uint64_t index) : obj(obj), index(index) {}
+            template <bool C = Const, typename = typename std::enable_if<C>::type>
+            basic_iterator(const basic_iterator<false>& that) : obj(that.obj), index(that.index) {}
+            
+            reference operator*(void) const { return (*obj)[index]; }
+            pointer operator->(void) const { return &(*obj)[index]; }
+            reference operator[](difference_type k) const { return (*obj)[index + k]; }
+            
+            basic_iterator& operator++(void) { ++index; return *this; }
+            basic_iterator operator++(int) { basic_iterator tmp(*this); ++index; return tmp; }
+            basic_iterator& operator--(void) { --index; return *this; }
+            basic_iterator operator--(int) { basic_iterator tmp(*this); --index; return tmp; }
+            
+            basic_iterator& operator+=(difference_type k) { index += k; return *this; }
+            basic_iterator& operator-=(difference_type k) { index -= k; return *this; }
+            basic_iterator operator+(difference_type k) const { return basic_iterator(obj, index + k); }
+            basic_iterator operator-(difference_type k) const { return basic_iterator(obj, index - k); }
+            friend basic_iterator operator+(difference_type k, const basic_iterator& it) { return it + k; }
+            difference_type operator-(const basic_iterator& that) const { return index - that.index; }
+            
+            bool operator==(const basic_iterator& that) const { return index == that.index; }
+            bool operator!=(const basic_iterator& that) const { return index != that.index; }
+            bool operator<(const basic_iterator& that) const { return index < that.index; }
+            bool operator>(const basic_iterator& that) const { return index > that.index; }
+            bool operator<=(const basic_iterator& that) const { return index <= that.index; }
+            bool operator>=(const basic_iterator& that) const { return index >= that.index; }
+            
+            friend class basic_iterator<true>;
+        };
+        
+        using iterator = basic_iterator<false>;
+        using const_iterator = basic_iterator<true>;
+        
+        iterator begin(void) { return iterator(this, 0); }
+        iterator end(void) { return iterator(this, size()); }
+        const_iterator begin(void) const { return const_iterator(this, 0); }
+        const_iterator end(void) const { return const_iterator(this, size()); }
+        const_iterator cbegin(void) const { return begin(); }
+        const_iterator cend(void) const { return end(); }
+    
+    private:
+        static uint64_t log2_floor(uint64_t v) {
+#if defined(__GNUC__)
+            return 63 - __builtin_clzll(v);
+#else
+            uint64_t r = 0;
+            while (v >>= 1) { ++r; }
+            return r;
+#endif
+        }
+        
+        static uint64_t bucket_of(uint64_t index) {
+            return log2_floor(index + (uint64_t(1) << first_bucket_bits)) - first_bucket_bits;
+        }
+        
+        static uint64_t bucket_start(uint64_t b) {
+            return (uint64_t(1) << (b + first_bucket_bits)) - (uint64_t(1) << first_bucket_bits);
+        }
+        
+        static uint64_t bucket_size(uint64_t b) {
+            return uint64_t(1) << (b + first_bucket_bits);
+        }
+        
+        // the first thread to need a bucket installs it; losers of the race
+        // free theirs.  The install is sequentially consistent for publish().
+        bucket* get_bucket(uint64_t b) {
+            bucket* bk = buckets[b].load(std::memory_order_acquire);
+            if (bk != nullptr) { return bk; }
+            bucket* fresh = make_bucket(b);
+            if (buckets[b].compare_exchange_strong(bk, fresh, std::memory_order_seq_cst, std::memory_order_acquire)) {
+                return fresh;
+            }
+            free_bucket(b, fresh);
+            return bk;
+        }
+        
+        bucket* make_bucket(uint64_t b) {
+            const uint64_t n = bucket_size(b);
+            bucket* bk = new bucket{ nullptr, nullptr };
+            try {
+                bk->slots = alloc_traits::allocate(alloc, n);
+                bk->states = new std::atomic<uint8_t>[n];
+            } catch (...) {
+                if (bk->slots != nullptr) { alloc_traits::deallocate(alloc, bk->slots, n); }
+                delete bk;
+                throw;
+            }
+            for (uint64_t k = 0; k < n; ++k) { bk->states[k].store(PENDING, std::memory_order_relaxed); }
+            return bk;
+        }
+        
+        void free_bucket(uint64_t b, bucket* bk) {
+            if (bk == nullptr) { return; }
+            alloc_traits::deallocate(alloc, bk->slots, bucket_size(b));
+            delete[] bk->states;
+            delete bk;
+        }
+        
+        // advances the ready prefix over every finished slot, including
+        // slots other threads finished but have not published yet.  The slot
+        // states, the bucket installs and the reservation counter are all
+        // sequentially consistent, so of two threads finishing neighbouring
+        // slots at least one sees the other's slot finished and carries the
+        // prefix past both.
+        void publish(void) {
+            uint64_t p = published.load(std::memory_order_acquire);
+            while (p < reserved.load()) {
+                const uint64_t b = bucket_of(p);
+                bucket* bk = buckets[b].load();
+                if (bk == nullptr || bk->states[p - bucket_start(b)].load() == PENDING) { return; }
+                if (published.compare_exchange_weak(p, p + 1, std::memory_order_acq_rel, std::memory_order_acquire)) { ++p; }
+            }
+        }
+        
+        T* slot(uint64_t k) const {
+            const uint64_t b = bucket_of(k);
+            return buckets[b].load(std::memory_order_acquire)->slots + (k - bucket_start(b));
+        }
+        
+        T* checked_slot(uint64_t k) const {
+            if (k >= size()) { throw std::out_of_range("index out of range"); }
+            const uint64_t b = bucket_of(k);
+            bucket* bk = buckets[b].load(std::memory_order_acquire);
+            if (bk->states[k - bucket_start(b)].load(std::memory_order_acquire) != READY) {
+                throw std::out_of_range("element construction failed");
+            }
+            return bk->slots + (k - bucket_start(b));
+        }
+    };
+    
+} //namespace epl
+
+#endif
@@ -0,0 +1,278 @@
+#ifndef _FLAT_MAP_H_
+#define _FLAT_MAP_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "Vector.h"
+
+namespace epl{
+    
+    namespace detail {
+        struct identity_key {
+            template <typename T>
+            const T& operator()(const T& v) const { return v; }
+        };
+        
+        struct first_key {
+            template <typename P>
+            const typename P::first_type& operator()(const P& v) const { return v.first; }
+        };
+        
+        // Sorted, duplicate-free storage shared by flat_set and flat_map.
+        // The values live in one epl::vector ordered by KeyOf()(value), and
+        // lookups are binary searches over its contiguous buffer.  A single
+        // insert goes through vector::insert, which shifts whichever side of
+        // the position is shorter, so keys landing near the front move the
+        // front elements toward data_start instead of shifting everything
+        // behind them.  MutableValues says whether iterators may write to
+        // the values (the mapped half of a flat_map) or not (a flat_set).
+        template <typename Key, typename Value, typename KeyOf, typename Compare, typename Checking, typename Alloc, bool MutableValues>
+        class flat_tree {
+        public:
+            using storage_type = vector<Value, Checking, Alloc>;
+            using key_type = Key;
+            using value_type = Value;
+            using key_compare = Compare;
+            using size_type = uint64_t;
+            using difference_type = std::ptrdiff_t;
+            using const_iterator = typename storage_type::const_iterator;
+            using iterator = typename std::conditional<MutableValues, typename storage_type::iterator, const_iterator>::type;
+        
+        protected:
+            storage_type items;
+            Compare comp;
+        
+        public:
+            flat_tree(void) {
+            }
+            
+            explicit flat_tree(const Compare& comp, const Alloc& alloc = Alloc()) : items(alloc), comp(comp) {
+            }
+            
+            template <typename Iterator>
+            flat_tree(Iterator first, Iterator last, const Compare& comp = Compare(), const Alloc& alloc = Alloc()) :
+            items(alloc), comp(comp) {
+                insert_range(first, last);
+            }
+            
+            flat_tree(std::initializer_list<Value> il, const Compare& comp = Compare(), const Alloc& alloc = Alloc()) :
+            flat_tree(il.begin(), il.end(), comp, alloc) {
+            }
+            
+            uint64_t size(void) const { return items.size(); }
+            bool empty(void) const { return items.size() == 0; }
+            uint64_t capacity(void) const { return items.capacity(); }
+            void reserve(uint64_t n) { items.reserve(n); }
+            void clear(void) { items.resize(0); }
+            void shrink_to_fit(void) { items.shrink_to_fit(); }
+            
+            key_compare key_comp(void) const { return comp; }
+            
+            // the values in key order, e.g. for epl::save
+            const storage_type& sequence(void) const { return items; }
+            
+            iterator begin(void) { return iterator_at(0); }
+            iterator end(void) { return iterator_at(size()); }
+            const_iterator begin(void) const { return items.begin(); }
+            const_iterator end(void) const { return items.end(); }
+            const_iterator cbegin(void) const { return items.begin(); }
+            const_iterator cend(void) const { return items.end(); }
+            
+            iterator find(const Key& k) { return iterator_at(find_index(k)); }
+            const_iterator find(const Key& k) const { return items.begin() + find_index(k); }
+            
+            bool contains(const Key& k) const { return find_index(k) != size(); }
+            uint64_t count(const Key& k) const { return contains(k) ? 1 : 0; }
+            
+            iterator lower_bound(const Key& k) { return iterator_at(lower_index(k)); }
+            const_iterator lower_bound(const Key& k) const { return items.begin() + lower_index(k); }
+            iterator upper_bound(const Key& k) { return iterator_at(upper_index(k)); }
+            const_iterator upper_bound(const Key& k) const { return items.begin() + upper_index(k); }
+            
+            std::pair<iterator, iterator> equal_range(const Key& k) {
+                uint64_t first = lower_index(k);
+                uint64_t last = (first != size() && !comp(k, KeyOf()(values()[first]))) ? first + 1 : first;
+                return std::make_pair(iterator_at(first), iterator_at(last));
+            }
+            
+            std::pair<iterator, bool> insert(const Value& v) {
+                return insert_value(v);
+            }
+            
+            std::pair<iterator, bool> insert(Value&& v) {
+                return insert_value(std::move(v));
+            }
+            
+            template <typename... Args>
+            std::pair<iterator, bool> emplace(Args&&... args) {
+                return insert_value(Value(std::forward<Args>(args)...));
+            }
+            
+            // Adds a batch of values in O(n + m log m) instead of m shifting
+            // inserts: the batch is appended behind the current values,
+            // sorted there, and merged with them in one pass.  The merge is
+            // stable, so for equal keys the value already present wins, and
+            // within the batch the first one does, as with repeated insert.
+            // The range must not point into this container.
+            template <typename Iterator>
+            void insert_range(Iterator first, Iterator last) {
+                uint64_t old_size = size();
+                items.append(first, last);
+                if (size() == old_size) { return; }
+                
+                Value* data = items.data();
+                Value* middle = data + old_size;
+                Value* end = data + size();
+                auto less = [this](const Value& a, const Value& b) { return comp(KeyOf()(a), KeyOf()(b)); };
+                std::stable_sort(middle, end, less);
+                if (old_size != 0 && less(*middle, *(middle - 1))) {
+                    std::inplace_merge(data, middle, end, less);
+                }
+                Value* unique_end = std::unique(data, end, [&less](const Value& a, const Value& b) { return !less(a, b); });
+                items.erase(items.cbegin() + (unique_end - data), items.cend());
+            }
+            
+            void insert(std::initializer_list<Value> il) {
+                insert_range(il.begin(), il.end());
+            }
+            
+            iterator erase(const_iterator pos) {
+                uint64_t index = pos - cbegin();
+                items.erase(pos);
+                return iterator_at(index);
+            }
+            
+            iterator erase(const_iterator first, const_iterator last) {
+                uint64_t index = first - cbegin();
+                items.erase(first, last);
+                return iterator_at(index);
+            }
+            
+            uint64_t erase(const Key& k) {
+                uint64_t index = find_index(k);
+                if (index == size()) { return 0; }
+                items.erase(items.cbegin() + index);
+                return 1;
+            }
+            
+            friend bool operator==(const flat_tree& a, const flat_tree& b) {
+                return a.size() == b.size() && std::equal(a.values(), a.values() + a.size(), b.values());
+            }
+            
+            friend bool operator!=(const flat_tree& a, const flat_tree& b) {
+                return !(a == b);
+            }
+        
+        protected:
+            iterator iterator_at(uint64_t index) {
+                return iterator_at(index, std::integral_constant<bool, MutableValues>{});
+            }
+            
+            iterator iterator_at(uint64_t index, std::true_type) { return items.begin() + index; }
+            iterator iterator_at(uint64_t index, std::false_type) { return static_cast<const storage_type&>(items).begin() + index; }
+            
+            // lookups search the raw buffer so that checked iterators are
+            // not validated at every probe; read through the const vector,
+            // which leaves a copy-on-write buffer shareable
+            const Value* values(void) const { return items.data(); }
+            
+            uint64_t lower_index(const Key& k) const {
+                const Value* data = values();
+                return std::lower_bound(data, data + size(), k, [this](const Value& v, const Key& key) {
+                    return comp(KeyOf()(v), key);
+                }) - data;
+            }
+            
+            uint64_t upper_index(const Key& k) const {
+                const Value* data = values();
+                return std::upper_bound(data, data + size(), k, [this](const Key& key, const Value& v) {
+                    return comp(key, KeyOf()(v));
+                }) - data;
+            }
+            
+            uint64_t find_index(const Key& k) const {
+                uint64_t index = lower_index(k);
+                if (index != size() && !comp(k, KeyOf()(values()[index]))) { return index; }
+                return size();
+            }
+            
+            template <typename V>
+            std::pair<iterator, bool> insert_value(V&& v) {
+                uint64_t index = lower_index(KeyOf()(v));
+                if (index != size() && !comp(KeyOf()(v), KeyOf()(values()[index]))) {
+                    return std::make_pair(iterator_at(index), false);
+                }
+                auto p = std::addressof(v);
+                items.insert(items.cbegin() + index, std::make_move_iterator(p), std::make_move_iterator(p + 1));
+                return std::make_pair(iterator_at(index), true);
+            }
+        };
+    }
+    
+    // Sorted set of unique keys in an epl::vector.  Lookup is a binary
+    // search; insert and erase shift the shorter side of the buffer.  Use
+    // insert_range to add many keys at once.  Iterators are the vector's
+    // const iterators, so they are checked under default_checking and are
+    // invalidated by any insert or erase.
+    template <typename Key, typename Compare = std::less<Key>, typename Checking = default_checking, typename Alloc = std::allocator<Key>>
+    class flat_set : public detail::flat_tree<Key, Key, detail::identity_key, Compare, Checking, Alloc, false> {
+        using base = detail::flat_tree<Key, Key, detail::identity_key, Compare, Checking, Alloc, false>;
+    
+    public:
+        using base::base;
+    };
+    
+    // Sorted map of unique keys in an epl::vector of std::pair<Key, T>.
+    // The key is not const in the pair, since the elements are moved around
+    // as the buffer shifts; writing to it through an iterator breaks the
+    // ordering.  Otherwise this behaves like flat_set.
+    template <typename Key, typename T, typename Compare = std::less<Key>, typename Checking = default_checking,
+              typename Alloc = std::allocator<std::pair<Key, T>>>
+    class flat_map : public detail::flat_tree<Key, std::pair<Key, T>, detail::first_key, Compare, Checking, Alloc, true> {
+        using base = detail::flat_tree<Key, std::pair<Key, T>, detail::first_key, Compare, Checking, Alloc, true>;
+    
+    public:
+        using mapped_type = T;
+        using typename base::iterator;
+        using base::base;
+        
+        T& operator[](const Key& k) {
+            return try_emplace(k).first->second;
+        }
+        
+        T& at(const Key& k) {
+            uint64_t index = this->find_index(k);
+            if (index == this->size()) { throw std::out_of_range("key not found"); }
+            return this->items[index].second;
+        }
+        
+        const T& at(const Key& k) const {
+            uint64_t index = this->find_index(k);
+            if (index == this->size()) { throw std::out_of_range("key not found"); }
+            return this->items[index].second;
+        }
+        
+        // builds the mapped value only if the key is not present
+        template <typename... Args>
+        std::pair<iterator, bool> try_emplace(const Key& k, Args&&... args) {
+            uint64_t index = this->lower_index(k);
+            if (index != this->size() && !this->comp(k, this->values()[index].first)) {
+                return std::make_pair(this->iterator_at(index), false);
+            }
+            std::pair<Key, T> v(std::piecewise_construct, std::forward_as_tuple(k), std::forward_as_tuple(std::forward<Args>(args)...));
+            this->items.insert(this->items.cbegin() + index, std::make_move_iterator(&v), std::make_move_iterator(&v + 1));
+            return std::make_pair(this->iterator_at(index), true);
+        }
+    };
+    
+} //namespace epl
+
+#endif
@@ -0,0 +1,262 @@
+#ifndef _KERNELS_H_
+#define _KERNELS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+
+#include "Vector.h"
+
+// Numeric kernels for vectors of arithmetic types.  They work on the raw
+// data_start..data_end range, so there is no per-element bounds check or
+// iterator validation in the loop, and are written in blocks of independent
+// lanes that the compiler turns into SIMD code.  With GCC on x86-64 each
+// kernel is compiled for AVX-512, AVX2, SSE4.2 and baseline x86-64, and the
+// loader picks the best one for the CPU at startup (ifunc dispatch).
+//
+// Floating-point sums and dot products add in lane order, not element
+// order, so results may differ from a sequential loop in the last bits.
+// NaNs make min_value/max_value/argmin/argmax unspecified.
+
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define EPL_SIMD_DISPATCH __attribute__((target_clones("avx512f", "avx2", "sse4.2", "default")))
+#else
+#define EPL_SIMD_DISPATCH
+#endif
+
+namespace epl{
+    
+    namespace detail {
+        // 64 bytes of lanes: one AVX-512 register, two AVX2 registers
+        template <typename T>
+        struct lanes { static const size_t count = 64 / sizeof(T); };
+        
+        template <typename T>
+        EPL_SIMD_DISPATCH
+        T simd_sum(const T* __restrict p, size_t n) {
+            const size_t L = lanes<T>::count;
+            T acc[L] = {};
+            size_t i = 0;
+            for (; i + L <= n; i += L) {
+                for (size_t j = 0; j < L; ++j) { acc[j] += p[i + j]; }
+            }
+            T s = 0;
+            for (size_t j = 0; j < L; ++j) { s += acc[j]; }
+            for (; i < n; ++i) { s += p[i]; }
+            return s;
+        }
+        
+        template <typename T>
+        EPL_SIMD_DISPATCH
+        T simd_dot(const T* __restrict a, const T* __restrict b, size_t n) {
+            const size_t L = lanes<T>::count;
+            T acc[L] = {};
+            size_t i = 0;
+            for (; i + L <= n; i += L) {
+                for (size_t j = 0; j < L; ++j) { acc[j] += a[i + j] * b[i + j]; }
+            }
+            T s = 0;
+            for (size_t j = 0; j < L; ++j) { s += acc[j]; }
+            for (; i < n; ++i) { s += a[i] * b[i]; }
+            return s;
+        }
+        
+        // n must be at least 1
+        template <typename T>
+        EPL_SIMD_DISPATCH
+        T simd_min(const T* __restrict p, size_t n) {
+            const size_t L = lanes<T>::count;
+            T m = p[0];
+            size_t i = 0;
+            if (n >= L) {
+                T acc[L];
+                for (size_t j = 0; j < L; ++j) { acc[j] = p[j]; }
+                for (i = L; i + L <= n; i += L) {
+                    for (size_t j = 0; j < L; ++j) { acc[j] = p[i + j] < acc[j] ? p[i + j] : acc[j]; }
+                }
+                m = acc[0];
+                for (size_t j = 1; j < L; ++j) { m = acc[j] < m ? acc[j] : m; }
+            }
+            for (; i < n; ++i) { m = p[i] < m ? p[i] : m; }
+            return m;
+        }
+        
+        template <typename T>
+        EPL_SIMD_DISPATCH
+        T simd_max(const T* __restrict p, size_t n) {
+            const size_t L = lanes<T>::count;
+            T m = p[0];
+            size_t i = 0;
+            if (n >= L) {
+                T acc[L];
+                for (size_t j = 0; j < L; ++j) { acc[j] = p[j]; }
+                for (i = L; i + L <= n; i += L) {
+                    for (size_t j = 0; j < L; ++j) { acc[j] = p[i + j] > acc[j] ? p[i + j] : acc[j]; }
+                }
+                m = acc[0];
+                for (size_t j = 1; j < L; ++j) { m = acc[j] > m ? acc[j] : m; }
+            }
+            for (; i < n; ++i) { m = p[i] > m ? p[i] : m; }
+            return m;
+        }
+        
+        // index of the first element equal to v, or n
+        template <typename T>
+        EPL_SIMD_DISPATCH
+        size_t simd_find(const T* __restrict p, size_t n, T v) {
+            const size_t L = lanes<T>::count;
+            size_t i = 0;
+            for (; i + L <= n; i += L) {
+                unsigned hit = 0;
+                for (size_t j = 0; j < L; ++j) { hit |= (p[i + j] == v); }
+                if (hit) { break; }
+            }
+            for (; i < n; ++i) {
+                if (p[i] == v) { return i; }
+            }
+            return n;
+        }
+        
+        template <typename T>
+        EPL_SIMD_DISPATCH
+        size_t simd_count(const T* __restrict p, size_t n, T v) {
+            const size_t L = lanes<T>::count;
+            size_t acc[L] = {};
+            size_t i = 0;
+            for (; i + L <= n; i += L) {
+                for (size_t j = 0; j < L; ++j) { acc[j] += (p[i + j] == v); }
+            }
+            size_t c = 0;
+            for (size_t j = 0; j < L; ++j) { c += acc[j]; }
+            for (; i < n; ++i) { c += (p[i] == v); }
+            return c;
+        }
+        
+        template <typename T>
+        EPL_SIMD_DISPATCH
+        void simd_fill(T* __restrict p, size_t n, T v) {
+            for (size_t i = 0; i < n; ++i) { p[i] = v; }
+        }
+        
+        template <typename T>
+        EPL_SIMD_DISPATCH
+        void simd_axpy(T a, const T* __restrict x, T* __restrict y, size_t n) {
+            for (size_t i = 0; i < n; ++i) { y[i] += a * x[i]; }
+        }
+        
+        // axpy(a, y, y): x and y above must not alias
+        template <typename T>
+        EPL_SIMD_DISPATCH
+        void simd_axpy_self(T a, T* __restrict y, size_t n) {
+            for (size_t i = 0; i < n; ++i) { y[i] += a * y[i]; }
+        }
+        
+        template <typename T>
+        EPL_SIMD_DISPATCH
+        void simd_less(const T* __restrict a, const T* __restrict b, uint8_t* __restrict out, size_t n) {
+            for (size_t i = 0; i < n; ++i) { out[i] = a[i] < b[i]; }
+        }
+        
+        template <typename T>
+        EPL_SIMD_DISPATCH
+        bool simd_equal(const T* __restrict a, const T* __restrict b, size_t n) {
+            const size_t L = lanes<T>::count;
+            size_t i = 0;
+            for (; i + L <= n; i += L) {
+                unsigned diff = 0;
+                for (size_t j = 0; j < L; ++j) { diff |= (a[i + j] != b[i + j]); }
+                if (diff) { return false; }
+            }
+            for (; i < n; ++i) {
+                if (a[i] != b[i]) { return false; }
+            }
+            return true;
+        }
+        
+        template <typename T, typename R = void>
+        using if_arithmetic = typename std::enable_if<std::is_arithmetic<T>::value, R>::type;
+        
+        inline void check_same_size(uint64_t a, uint64_t b) {
+            if (a != b) { throw std::invalid_argument("vectors differ in size"); }
+        }
+    }
+    
+    template <typename T, typename C, typename A, std::size_t N, typename G>
+    detail::if_arithmetic<T, T> sum(const vector<T, C, A, N, G>& x) {
+        return detail::simd_sum(x.data(), x.size());
+    }
+    
+    template <typename T, typename C, typename A, std::size_t N, typename G, typename C2, typename A2, std::size_t N2, typename G2>
+    detail::if_arithmetic<T, T> dot(const vector<T, C, A, N, G>& x, const vector<T, C2, A2, N2, G2>& y) {
+        detail::check_same_size(x.size(), y.size());
+        return detail::simd_dot(x.data(), y.data(), x.size());
+    }
+    
+    template <typename T, typename C, typename A, std::size_t N, typename G>
+    detail::if_arithmetic<T, T> min_value(const vector<T, C, A, N, G>& x) {
+        if (x.size() == 0) { throw std::out_of_range("empty Vector"); }
+        return detail::simd_min(x.data(), x.size());
+    }
+    
+    template <typename T, typename C, typename A, std::size_t N, typename G>
+    detail::if_arithmetic<T, T> max_value(const vector<T, C, A, N, G>& x) {
+        if (x.size() == 0) { throw std::out_of_range("empty Vector"); }
+        return detail::simd_max(x.data(), x.size());
+    }
+    
+    // index of the first smallest / largest element: a vectorized reduction
+    // for the value followed by a vectorized search for it
+    template <typename T, typename C, typename A, std::size_t N, typename G>
+    detail::if_arithmetic<T, uint64_t> argmin(const vector<T, C, A, N, G>& x) {
+        return detail::simd_find(x.data(), x.size(), min_value(x));
+    }
+    
+    template <typename T, typename C, typename A, std::size_t N, typename G>
+    detail::if_arithmetic<T, uint64_t> argmax(const vector<T, C, A, N, G>& x) {
+        return detail::simd_find(x.data(), x.size(), max_value(x));
+    }
+    
+    // index of the first element equal to v, or size() if there is none
+    template <typename T, typename C, typename A, std::size_t N, typename G>
+    detail::if_arithmetic<T, uint64_t> find(const vector<T, C, A, N, G>& x, T v) {
+        return detail::simd_find(x.data(), x.size(), v);
+    }
+    
+    template <typename T, typename C, typename A, std::size_t N, typename G>
+    detail::if_arithmetic<T, uint64_t> count(const vector<T, C, A, N, G>& x, T v) {
+        return detail::simd_count(x.data(), x.size(), v);
+    }
+    
+    template <typename T, typename C, typename A, std::size_t N, typename G>
+    detail::if_arithmetic<T> fill(vector<T, C, A, N, G>& x, T v) {
+        detail::simd_fill(x.data(), x.size(), v);
+    }
+    
+    // y[i] += a * x[i]
+    template <typename T, typename C, typename A, std::size_t N, typename G, typename C2, typename A2, std::size_t N2, typename G2>
+    detail::if_arithmetic<T> axpy(T a, const vector<T, C, A, N, G>& x, vector<T, C2, A2, N2, G2>& y) {
+        detail::check_same_size(x.size(), y.size());
+        if (static_cast<const void*>(x.data()) == static_cast<const void*>(y.data())) {
+            detail::simd_axpy_self(a, y.data(), y.size());
+        } else {
+            detail::simd_axpy(a, x.data(), y.data(), x.size());
+        }
+    }
+    
+    // out[i] = x[i] < y[i], with out resized to match
+    template <typename T, typename C, typename A, std::size_t N, typename G, typename C2, typename A2, std::size_t N2, typename G2, typename C3, typename A3, std::size_t N3, typename G3>
+    detail::if_arithmetic<T> less(const vector<T, C, A, N, G>& x, const vector<T, C2, A2, N2, G2>& y, vector<uint8_t, C3, A3, N3, G3>& out) {
+        detail::check_same_size(x.size(), y.size());
+        out.resize(x.size());
+        detail::simd_less(x.data(), y.data(), out.data(), x.size());
+    }
+    
+    template <typename T, typename C, typename A, std::size_t N, typename G, typename C2, typename A2, std::size_t N2, typename G2>
+    detail::if_arithmetic<T, bool> equal(const vector<T, C, A, N, G>& x, const vector<T, C2, A2, N2, G2>& y) {
+        return x.size() == y.size() && detail::simd_equal(x.data(), y.data(), x.size());
+    }
+    
+} //namespace epl
+
+#endif
@@ -0,0 +1,429 @@
+#ifndef _PARALLEL_H_
+#define _PARALLEL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Vector.h"
+
+// Parallel for_each, transform, reduce and sort over contiguous ranges, run
+// on a work-stealing thread pool.  Ranges are given as raw pointers or
+// epl::vector iterators; other iterators (std::deque, chunked_vector, ...)
+// are rejected at compile time.
+//
+// A range is split into chunks whose boundaries fall on 64-byte cache lines
+// measured from the first element (data_start for a whole vector, which need
+// not be aligned with front room in the buffer), so two threads never write
+// the same line.  Each chunk turns its begin iterator into a raw pointer once
+// and then works on the pointer: with checked iterators the version check runs
+// once per chunk, not once per element.  The container must not be resized
+// while an algorithm runs.
+
+namespace epl{
+    
+    // Every thread owns a task deque: it pushes and pops at the back, idle
+    // threads steal from the front of the others.  Threads that wait on a
+    // task_group (including the caller, which is not a pool thread) run
+    // tasks while they wait, so a pool of n threads has n - 1 workers and
+    // thread_pool(1) runs everything on the caller.
+    class thread_pool {
+        struct task_queue {
+            std::mutex lock;
+            std::deque<std::function<void()>> tasks;
+        };
+        
+        std::vector<std::unique_ptr<task_queue>> queues; // queues[0] is shared by outside threads
+        std::vector<std::thread> workers;
+        std::atomic<uint64_t> queued;
+        bool stopping;
+        std::mutex idle_lock;
+        std::condition_variable idle;
+    
+    public:
+        explicit thread_pool(uint64_t threads = std::thread::hardware_concurrency()) : queued(0), stopping(false) {
+            if (threads == 0) { threads = 1; }
+            for (uint64_t k = 0; k < threads; ++k) {
+                queues.emplace_back(new task_queue);
+            }
+            for (uint64_t k = 1; k < threads; ++k) {
+                workers.emplace_back([this, k] { work(k); });
+            }
+        }
+        
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+        
+        ~thread_pool(void) {
+            {
+                std::lock_guard<std::mutex> guard(idle_lock);
+                stopping = true;
+            }
+            idle.notify_all();
+            for (std::thread& t : workers) { t.join(); }
+        }
+        
+        uint64_t size(void) const { return queues.size(); }
+        
+        void submit(std::function<void()> task) {
+            task_queue& q = *queues[own_queue()];
+            {
+                std::lock_guard<std::mutex> guard(q.lock);
+                q.tasks.push_back(std::move(task));
+            }
+            ++queued;
+            { std::lock_guard<std::mutex> guard(idle_lock); }
+            idle.notify_one();
+        }
+        
+        // runs one queued task on the calling thread, own queue first
+        bool run_one(void) {
+            const uint64_t self = own_queue();
+            std::function<void()> task;
+            if (! pop(*queues[self], task, true)) {
+                bool stolen = false;
+                for (uint64_t k = 1; k < queues.size() && ! stolen; ++k) {
+                    stolen = pop(*queues[(self + k) % queues.size()], task, false);
+                }
+                if (! stolen) { return false; }
+            }
+            task();
+            return true;
+        }
+        
+        // pool used by the algorithms when none is given
+        static thread_pool& shared(void) {
+            static thread_pool pool;
+            return pool;
+        }
+    
+    private:
+        struct worker_id {
+            const thread_pool* pool;
+            uint64_t index;
+        };
+        
+        static worker_id& current(void) {
+            static thread_local worker_id id = { nullptr, 0 };
+            return id;
+        }
+        
+        uint64_t own_queue(void) const {
+            return current().pool == this ? current().index : 0;
+        }
+        
+        bool pop(task_queue& q, std::function<void()>& task, bool back) {
+            std::lock_guard<std::mutex> guard(q.lock);
+            if (q.tasks.empty()) { return false; }
+            if (back) {
+                task = std::move(q.tasks.back());
+                q.tasks.pop_back();
+            } else {
+                task = std::move(q.tasks.front());
+                q.tasks.pop_front();
+            }
+            --queued;
+            return true;
+        }
+        
+        void work(uint64_t index) {
+            current() = worker_id{ this, index };
+            for (;;) {
+                if (run_one()) { continue; }
+                std::unique_lock<std::mutex> guard(idle_lock);
+                idle.wait(guard, [this] { return stopping || queued != 0; });
+                if (stopping) { return; }
+            }
+        }
+    };
+    
+    // A set of tasks that can be waited on.  The first exception thrown by a
+    // task is rethrown from wait(), after all tasks have finished.
+    class task_group {
+        thread_pool& pool;
+        std::atomic<uint64_t> pending;
+        std::exception_ptr error;
+        std::mutex error_lock;
+    
+    public:
+        explicit task_group(thread_pool& pool) : pool(pool), pending(0) {}
+        
+        task_group(const task_group&) = delete;
+        task_group& operator=(const task_group&) = delete;
+        
+        ~task_group(void) {
+            while (pending != 0) { help(); }
+        }
+        
+        template <typename F>
+        void run(F f) {
+            ++pending;
+            pool.submit([this, f] {
+                try {
+                    f();
+                } catch (...) {
+                    std::lock_guard<std::mutex> guard(error_lock);
+                    if (! error) { error = std::current_exception(); }
+                }
+                --pending;
+            });
+        }
+        
+        void wait(void) {
+            while (pending != 0) { help(); }
+            if (error) {
+                std::exception_ptr e = error;
+                error = nullptr;
+                std::rethrow_exception(e);
+            }
+        }
+    
+    private:
+        void help(void) {
+            if (! pool.run_one()) { std::this_thread::yield(); }
+        }
+    };
+    
+    namespace detail {
+        // at least 16KiB of elements per chunk, about four chunks per thread
+        template <typename T>
+        uint64_t chunk_size(const thread_pool& pool, uint64_t n) {
+            const uint64_t grain = std::max<uint64_t>(1, 16384 / sizeof(T));
+            return std::max(grain, (n + 4 * pool.size() - 1) / (4 * pool.size()));
+        }
+        
+        // index of the k-th chunk boundary, rounded up to a cache line
+        template <typename T>
+        uint64_t chunk_boundary(const T* base, uint64_t n, uint64_t chunk, uint64_t k) {
+            if (k == 0) { return 0; }
+            if (k * chunk >= n) { return n; }
+            const uintptr_t start = reinterpret_cast<uintptr_t>(base);
+            const uintptr_t line = (reinterpret_cast<uintptr_t>(base + k * chunk) + 63) & ~uintptr_t(63);
+            return std::min<uint64_t>(n, (line - start + sizeof(T) - 1) / sizeof(T));
+        }
+        
+        // calls f(lo, hi) for each chunk of [0, n), in parallel
+        template <typename T, typename F>
+        void for_each_chunk(thread_pool& pool, const T* base, uint64_t n, F&& f) {
+            const uint64_t chunk = chunk_size<T>(pool, n);
+            if (pool.size() == 1 || n <= chunk) {
+                f(0, n);
+                return;
+            }
+            task_group group(pool);
+            const uint64_t chunks = (n + chunk - 1) / chunk;
+            for (uint64_t k = 0; k < chunks; ++k) {
+                const uint64_t lo = chunk_boundary(base, n, chunk, k);
+                const uint64_t hi = chunk_boundary(base, n, chunk, k + 1);
+                if (lo < hi) { group.run([&f, lo, hi] { f(lo, hi); }); }
+            }
+            group.wait();
+        }
+        
+        // uninitialized buffer that destroys its elements when they exist
+        template <typename T>
+        struct sort_buffer {
+            T* data;
+            uint64_t n;
+            bool constructed;
+            
+            explicit sort_buffer(uint64_t n) : data(std::allocator<T>().allocate(n)), n(n), constructed(false) {}
+            
+            ~sort_buffer(void) {
+                if (constructed) {
+                    for (uint64_t k = 0; k < n; ++k) { data[k].~T(); }
+                }
+                std::allocator<T>().deallocate(data, n);
+            }
+        };
+        
+        // merges sorted [a, a + na) and [b, b + nb) into out in up to `pieces`
+        // independent tasks, splitting at elements of the first run
+        template <typename T, typename Compare>
+        void parallel_merge(task_group& group, T* a, uint64_t na, T* b, uint64_t nb, T* out, uint64_t pieces, Compare& comp) {
+            uint64_t a_lo = 0, b_lo = 0;
+            for (uint64_t k = 1; k <= pieces; ++k) {
+                const uint64_t a_hi = k == pieces ? na : na * k / pieces;
+                const uint64_t b_hi = k == pieces ? nb : std::lower_bound(b, b + nb, a[a_hi], comp) - b;
+                T* dest = out + a_lo + b_lo;
+                group.run([=, &comp] {
+                    std::merge(std::make_move_iterator(a + a_lo), std::make_move_iterator(a + a_hi),
+                               std::make_move_iterator(b + b_lo), std::make_move_iterator(b + b_hi), dest, comp);
+                });
+                a_lo = a_hi;
+                b_lo = b_hi;
+            }
+        }
+    }
+    
+    namespace parallel {
+        
+        template <typename Iterator, typename Function>
+        void for_each(thread_pool& pool, Iterator first, Iterator last, Function f) {
+            static_assert(detail::is_contiguous_iterator<Iterator>::value, "parallel algorithms need pointers or vector iterators");
+            const uint64_t n = last - first;
+            if (n == 0) { return; }
+            auto base = detail::to_address(first);
+            detail::for_each_chunk(pool, base, n, [&](uint64_t lo, uint64_t hi) {
+                auto p = detail::to_address(first + lo);
+                for (uint64_t k = 0; k < hi - lo; ++k) { f(p[k]); }
+            });
+        }
+        
+        template <typename Iterator, typename Function>
+        void for_each(Iterator first, Iterator last, Function f) {
+            for_each(thread_pool::shared(), first, last, f);
+        }
+        
+        // d_first may be first, for an in-place transform
+        template <typename Iterator, typename OutputIterator, typename UnaryOperation>
+        OutputIterator transform(thread_pool& pool, Iterator first, Iterator last, OutputIterator d_first, UnaryOperation op) {
+            static_assert(detail::is_contiguous_iterator<Iterator>::value, "parallel algorithms need pointers or vector iterators");
+            static_assert(detail::is_contiguous_iterator<OutputIterator>::value, "parallel algorithms need pointers or vector iterators");
+            const uint64_t n = last - first;
+            if (n == 0) { return d_first; }
+            auto out = detail::to_address(d_first);
+            detail::for_each_chunk(pool, out, n, [&](uint64_t lo, uint64_t hi) {
+                auto p = detail::to_address(first + lo);
+                auto q = detail::to_address(d_first + lo);
+                for (uint64_t k = 0; k < hi - lo; ++k) { q[k] = op(p[k]); }
+            });
+            return d_first + n;
+        }
+        
+        template <typename Iterator, typename OutputIterator, typename UnaryOperation>
+        OutputIterator transform(Iterator first, Iterator last, OutputIterator d_first, UnaryOperation op) {
+            return transform(thread_pool::shared(), first, last, d_first, op);
+        }
+        
+        // op must be associative; chunks are combined in order, left to right
+        template <typename Iterator, typename T, typename BinaryOperation>
+        T reduce(thread_pool& pool, Iterator first, Iterator last, T init, BinaryOperation op) {
+            static_assert(detail::is_contiguous_iterator<Iterator>::value, "parallel algorithms need pointers or vector iterators");
+            const uint64_t n = last - first;
+            if (n == 0) { return init; }
+            auto base = detail::to_address(first);
+            const uint64_t chunk = detail::chunk_size<typename std::iterator_traits<Iterator>::value_type>(pool, n);
+            std::vector<T> partial((n + chunk - 1) / chunk, init);
+            std::vector<char> used(partial.size(), false);
+            detail::for_each_chunk(pool, base, n, [&](uint64_t lo, uint64_t hi) {
+                auto p = detail::to_address(first + lo);
+                T acc(p[0]);
+                for (uint64_t k = 1; k < hi - lo; ++k) { acc = op(std::move(acc), p[k]); }
+                partial[lo / chunk] = std::move(acc);
+                used[lo / chunk] = true;
+            });
+            for (uint64_t k = 0; k < partial.size(); ++k) {
+                if (used[k]) { init = op(std::move(init), partial[k]); }
+            }
+            return init;
+        }
+        
+        template <typename Iterator, typename T, typename BinaryOperation>
+        T reduce(Iterator first, Iterator last, T init, BinaryOperation op) {
+            return reduce(thread_pool::shared(), first, last, init, op);
+        }
+        
+        template <typename Iterator, typename T>
+        T reduce(Iterator first, Iterator last, T init) {
+            return reduce(thread_pool::shared(), first, last, init, std::plus<T>());
+        }
+        
+        // Sorts the chunks in parallel, then merges pairs of runs level by
+        // level between the range and a scratch buffer, each merge split into
+        // independent pieces.  Not stable.  Types whose move constructor can
+        // throw are sorted on the calling thread.
+        template <typename Iterator, typename Compare>
+        void sort(thread_pool& pool, Iterator first, Iterator last, Compare comp) {
+            static_assert(detail::is_contiguous_iterator<Iterator>::value, "parallel algorithms need pointers or vector iterators");
+            typedef typename std::iterator_traits<Iterator>::value_type T;
+            const uint64_t n = last - first;
+            if (n < 2) { return; }
+            T* base = detail::to_address(first);
+            const uint64_t chunk = detail::chunk_size<T>(pool, n);
+            if (pool.size() == 1 || n <= chunk || ! std::is_nothrow_move_constructible<T>::value) {
+                std::sort(base, base + n, comp);
+                return;
+            }
+            
+            std::vector<uint64_t> runs;
+            for (uint64_t k = 0; runs.empty() || runs.back() < n; ++k) {
+                runs.push_back(detail::chunk_boundary(base, n, chunk, k));
+            }
+            detail::sort_buffer<T> buffer(n);
+            {
+                task_group group(pool);
+                for (uint64_t k = 0; k + 1 < runs.size(); ++k) {
+                    const uint64_t lo = runs[k], hi = runs[k + 1];
+                    group.run([=, &comp] { std::sort(base + lo, base + hi, comp); });
+                }
+                group.wait();
+            }
+            // moves cannot throw, so the buffer is either fully built or untouched
+            detail::for_each_chunk(pool, base, n, [=, &buffer](uint64_t lo, uint64_t hi) {
+                std::uninitialized_copy(std::make_move_iterator(base + lo), std::make_move_iterator(base + hi), buffer.data + lo);
+            });
+            buffer.constructed = true;
+            
+            T* from = buffer.data;
+            T* to = base;
+            while (runs.size() > 2) {
+                const uint64_t pairs = (runs.size() - 1) / 2;
+                const uint64_t pieces = std::max<uint64_t>(1, 2 * pool.size() / pairs);
+                std::vector<uint64_t> merged;
+                task_group group(pool);
+                uint64_t k = 0;
+                for (; k + 2 < runs.size(); k += 2) {
+                    const uint64_t lo = runs[k], mid = runs[k + 1], hi = runs[k + 2];
+                    detail::parallel_merge(group, from + lo, mid - lo, from + mid, hi - mid, to + lo, pieces, comp);
+                    merged.push_back(lo);
+                }
+                if (k + 1 < runs.size()) {
+                    const uint64_t lo = runs[k], hi = runs[k + 1];
+                    group.run([=] { std::move(from + lo, from + hi, to + lo); });
+                    merged.push_back(lo);
+                }
+                merged.push_back(n);
+                group.wait();
+                runs.swap(merged);
+                std::swap(from, to);
+            }
+            if (from != base) {
+                detail::for_each_chunk(pool, base, n, [=](uint64_t lo, uint64_t hi) {
+                    std::move(from + lo, from + hi, base + lo);
+                });
+            }
+        }
+        
+        template <typename Iterator>
+        void sort(thread_pool& pool, Iterator first, Iterator last) {
+            sort(pool, first, last, std::less<typename std::iterator_traits<Iterator>::value_type>());
+        }
+        
+        template <typename Iterator, typename Compare>
+        void sort(Iterator first, Iterator last, Compare comp) {
+            sort(thread_pool::shared(), first, last, comp);
+        }
+        
+        template <typename Iterator>
+        void sort(Iterator first, Iterator last) {
+            sort(thread_pool::shared(), first, last);
+        }
+        
+    } //namespace parallel
+    
+} //namespace epl
+
+#endif
@@ -0,0 +1,326 @@
+#ifndef _PERSISTENCE_H_
+#define _PERSISTENCE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Vector.h"
+
+// Binary files of trivially copyable elements: a 64-byte header followed by
+// the elements exactly as they are laid out in memory.  save() and load()
+// copy between a vector and such a file; mapped_vector_view maps the file and
+// reads the elements in place, so opening it costs page faults rather than
+// parsing and allocation.
+//
+// Files are only portable between builds with the same element layout and
+// byte order; both are recorded in the header and checked on open.
+
+namespace epl{
+    
+    struct file_header {
+        char magic[8];              // "EPLVEC" followed by two zero bytes
+        uint32_t format_version;
+        uint32_t header_size;       // the elements start here, 64-byte aligned
+        uint32_t element_size;
+        uint32_t element_align;
+        uint64_t byte_order;        // byte_order_mark as written by the saving machine
+        uint64_t count;
+        uint64_t checksum;          // of the element bytes, see detail::checksum
+        uint64_t reserved[2];
+        
+        static const uint32_t current_version = 1;
+        static const uint64_t byte_order_mark = 0x0102030405060708ull;
+    };
+    static_assert(sizeof(file_header) == 64, "file_header must stay 64 bytes");
+    
+    namespace detail {
+        // Four independent multiply-rotate lanes over 8-byte words, so that
+        // hashing keeps up with reading from disk.  Not cryptographic.  Data
+        // may be fed in pieces; every piece but the last must be a multiple
+        // of 32 bytes.
+        class checksum_state {
+            static const uint64_t p1 = 0x9E3779B185EBCA87ull;
+            static const uint64_t p2 = 0xC2B2AE3D27D4EB4Full;
+            
+            uint64_t lane[4] = { p1, p2, ~p1, ~p2 };
+            uint64_t total = 0;
+            uint64_t tail = 0;
+        
+        public:
+            void update(const void* data, uint64_t bytes) {
+                const unsigned char* p = static_cast<const unsigned char*>(data);
+                uint64_t k = 0;
+                for (; k + 32 <= bytes; k += 32) {
+                    for (int j = 0; j < 4; ++j) {
+                        uint64_t w;
+                        std::memcpy(&w, p + k + 8 * j, 8);
+                        lane[j] ^= w * p2;
+                        lane[j] = ((lane[j] << 31) | (lane[j] >> 33)) * p1;
+                    }
+                }
+                for (; k < bytes; ++k) { tail = (tail ^ p[k]) * p1; }
+                total += bytes;
+            }
+            
+            uint64_t finish(void) const {
+                uint64_t h = total * p1;
+                for (int j = 0; j < 4; ++j) { h = (h ^ lane[j]) * p2; }
+                h = (h ^ tail) * p1;
+                return h ^ (h >> 29);
+            }
+        };
+        
+        inline uint64_t checksum(const void* data, uint64_t bytes) {
+            checksum_state s;
+            s.update(data, bytes);
+            return s.finish();
+        }
+        
+        template <typename T>
+        file_header make_header(const T* data, uint64_t count) {
+            file_header h;
+            std::memset(&h, 0, sizeof(h));
+            std::memcpy(h.magic, "EPLVEC", 6);
+            h.format_version = file_header::current_version;
+            h.header_size = sizeof(file_header);
+            h.element_size = sizeof(T);
+            h.element_align = alignof(T);
+            h.byte_order = file_header::byte_order_mark;
+            h.count = count;
+            h.checksum = checksum(data, count * sizeof(T));
+            return h;
+        }
+        
+        // throws std::runtime_error unless h describes `bytes` bytes of T elements
+        template <typename T>
+        void check_header(const file_header& h, uint64_t bytes, const std::string& path) {
+            if (bytes < sizeof(file_header) || std::memcmp(h.magic, "EPLVEC\0\0", 8) != 0) {
+                throw std::runtime_error(path + ": not a vector file");
+            }
+            if (h.format_version != file_header::current_version || h.header_size != sizeof(file_header)) {
+                throw std::runtime_error(path + ": unsupported format version");
+            }
+            if (h.byte_order != file_header::byte_order_mark) {
+                throw std::runtime_error(path + ": saved with a different byte order");
+            }
+            if (h.element_size != sizeof(T) || h.element_align != alignof(T)) {
+                throw std::runtime_error(path + ": element size or alignment does not match");
+            }
+            if (h.count > (bytes - sizeof(file_header)) / sizeof(T)) {
+                throw std::runtime_error(path + ": truncated");
+            }
+        }
+        
+        struct file_closer {
+            void operator()(std::FILE* f) const { std::fclose(f); }
+        };
+        using file_ptr = std::unique_ptr<std::FILE, file_closer>;
+    }
+    
+    // Writes to path.tmp and renames it over path, so readers never see a
+    // half-written file.
+    template <typename T, typename C, typename A, std::size_t N, typename G>
+    void save(const vector<T, C, A, N, G>& x, const std::string& path) {
+        static_assert(std::is_trivially_copyable<T>::value, "save needs trivially copyable elements");
+        static_assert(alignof(T) <= sizeof(file_header), "elements must fit the header alignment");
+        const file_header h = detail::make_header(x.data(), x.size());
+        const std::string tmp = path + ".tmp";
+        {
+            detail::file_ptr f(std::fopen(tmp.c_str(), "wb"));
+            if (! f) { throw std::runtime_error(tmp + ": cannot open for writing"); }
+            const uint64_t bytes = x.size() * sizeof(T);
+            if (std::fwrite(&h, sizeof(h), 1, f.get()) != 1 ||
+                (bytes != 0 && std::fwrite(x.data(), 1, bytes, f.get()) != bytes) ||
+                std::fflush(f.get()) != 0) {
+                f.reset();
+                std::remove(tmp.c_str());
+                throw std::runtime_error(tmp + ": write failed");
+            }
+        }
+        if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+            std::remove(tmp.c_str());
+            throw std::runtime_error(path + ": cannot replace");
+        }
+    }
+    
+    // Replaces the contents of x with the file's elements.  The file is read
+    // in pieces of about 1MiB that are hashed while in cache and appended
+    // with memcpy, so the vector's buffer is written once and never
+    // zero-filled first.
+    template <typename T, typename C, typename A, std::size_t N, typename G>
+    void load(vector<T, C, A, N, G>& x, const std::string& path) {
+        static_assert(std::is_trivially_copyable<T>::value, "load needs trivially copyable elements");
+        detail::file_ptr f(std::fopen(path.c_str(), "rb"));
+        if (! f) { throw std::runtime_error(path + ": cannot open for reading"); }
+        file_header h;
+        std::memset(&h, 0, sizeof(h));
+        std::fseek(f.get(), 0, SEEK_END);
+        const long bytes = std::ftell(f.get());
+        std::fseek(f.get(), 0, SEEK_SET);
+        if (bytes < 0 || std::fread(&h, 1, sizeof(h), f.get()) != sizeof(h)) {
+            throw std::runtime_error(path + ": not a vector file");
+        }
+        detail::check_header<T>(h, (uint64_t) bytes, path);
+        
+        vector<T, C, A, N, G> result(x.get_allocator());
+        result.reserve(h.count);
+        // a multiple of 32 elements keeps every piece a whole number of checksum blocks
+        const uint64_t piece = std::max<uint64_t>(32, ((uint64_t(1) << 20) / sizeof(T)) & ~uint64_t(31));
+        std::allocator<T> raw;
+        T* buffer = raw.allocate(piece);
+        try {
+            detail::checksum_state sum;
+            for (uint64_t done = 0; done < h.count; ) {
+                const uint64_t n = std::min(piece, h.count - done);
+                if (std::fread(buffer, sizeof(T), n, f.get()) != n) {
+                    throw std::runtime_error(path + ": truncated");
+                }
+                sum.update(buffer, n * sizeof(T));
+                result.append(buffer, buffer + n);
+                done += n;
+            }
+            if (sum.finish() != h.checksum) {
+                throw std::runtime_error(path + ": checksum mismatch");
+            }
+        } catch (...) {
+            raw.deallocate(buffer, piece);
+            throw;
+        }
+        raw.deallocate(buffer, piece);
+        x = std::move(result);
+    }
+    
+    // Read-only view of a file written by save().  On Linux the file is
+    // mapped, nothing is copied and pages are read on first touch; elsewhere
+    // it is read into memory once.  The checksum is verified only on request,
+    // since that reads the whole file up front.
+    template <typename T>
+    class mapped_vector_view {
+        static_assert(std::is_trivially_copyable<T>::value, "mapped_vector_view needs trivially copyable elements");
+        
+        void* base = nullptr;   // the mapping or buffer, header included
+        uint64_t length = 0;
+        const T* first = nullptr;
+        uint64_t count = 0;
+    
+    public:
+        using value_type = T;
+        using const_reference = const T&;
+        using size_type = uint64_t;
+        using difference_type = std::ptrdiff_t;
+        using const_iterator = const T*; // the view never changes, so iterators need no checking
+        
+        explicit mapped_vector_view(const std::string& path, bool verify_checksum = false) {
+            open(path);
+            const file_header& h = *static_cast<const file_header*>(base);
+            try {
+                detail::check_header<T>(h, length, path);
+                if (verify_checksum && detail::checksum(static_cast<const char*>(base) + sizeof(file_header), h.count * sizeof(T)) != h.checksum) {
+                    throw std::runtime_error(path + ": checksum mismatch");
+                }
+            } catch (...) {
+                close();
+                throw;
+            }
+            first = reinterpret_cast<const T*>(static_cast<const char*>(base) + sizeof(file_header));
+            count = h.count;
+        }
+        
+        mapped_vector_view(const mapped_vector_view&) = delete;
+        mapped_vector_view& operator=(const mapped_vector_view&) = delete;
+        
+        mapped_vector_view(mapped_vector_view&& that) : base(that.base), length(that.length), first(that.first), count(that.count) {
+            that.base = nullptr;
+            that.length = that.count = 0;
+            that.first = nullptr;
+        }
+        
+        ~mapped_vector_view(void) {
+            close();
+        }
+        
+        uint64_t size(void) const { return count; }
+        const T* data(void) const { return first; }
+        
+        const T& operator[](uint64_t k) const {
+            if (k >= count) { throw std::out_of_range("index out of range"); }
+            return first[k];
+        }
+        
+        const T& front(void) const {
+            if (count == 0) { throw std::out_of_range("empty Vector"); }
+            return first[0];
+        }
+        
+        const T& back(void) const {
+            if (count == 0) { throw std::out_of_range("back called on empty Vector"); }
+            return first[count - 1];
+        }
+        
+        const_iterator begin(void) const { return first; }
+        const_iterator end(void) const { return first + count; }
+        const_iterator cbegin(void) const { return begin(); }
+        const_iterator cend(void) const { return end(); }
+    
+    private:
+        void open(const std::string& path) {
+#ifdef __linux__
+            const int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) { throw std::runtime_error(path + ": cannot open for reading"); }
+            struct stat st;
+            if (::fstat(fd, &st) != 0 || (uint64_t) st.st_size < sizeof(file_header)) {
+                ::close(fd);
+                throw std::runtime_error(path + ": not a vector file");
+            }
+            length = st.st_size;
+            base = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (base == MAP_FAILED) {
+                base = nullptr;
+                throw std::runtime_error(path + ": cannot map");
+            }
+#else
+            detail::file_ptr f(std::fopen(path.c_str(), "rb"));
+            if (! f) { throw std::runtime_error(path + ": cannot open for reading"); }
+            std::fseek(f.get(), 0, SEEK_END);
+            const long bytes = std::ftell(f.get());
+            std::fseek(f.get(), 0, SEEK_SET);
+            if (bytes < (long) sizeof(file_header)) { throw std::runtime_error(path + ": not a vector file"); }
+            length = bytes;
+            base = ::operator new(length, std::align_val_t(alignof(file_header) > alignof(T) ? alignof(file_header) : alignof(T)));
+            if (std::fread(base, 1, length, f.get()) != length) {
+                close();
+                throw std::runtime_error(path + ": read failed");
+            }
+#endif
+        }
+        
+        void close(void) {
+            if (base == nullptr) { return; }
+#ifdef __linux__
+            ::munmap(base, length);
+#else
+            ::operator delete(base, std::align_val_t(alignof(file_header) > alignof(T) ? alignof(file_header) : alignof(T)));
+#endif
+            base = nullptr;
+        }
+    };
+    
+} //namespace epl
+
+#endif
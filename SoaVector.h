@@ -0,0 +1,359 @@
+#ifndef _SOA_VECTOR_H_
+#define _SOA_VECTOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "Vector.h"
+
+namespace epl{
+    
+    // Contiguous read/write view of one column of a soa_vector.  Indexing is
+    // unchecked: spans are for hot loops over a single field.
+    template <typename T>
+    class column_span {
+        T* first;
+        uint64_t count;
+    
+    public:
+        using value_type = typename std::remove_const<T>::type;
+        using iterator = T*;
+        
+        column_span(T* first, uint64_t count) : first(first), count(count) {}
+        
+        uint64_t size(void) const { return count; }
+        T* data(void) const { return first; }
+        T& operator[](uint64_t k) const { return first[k]; }
+        T* begin(void) const { return first; }
+        T* end(void) const { return first + count; }
+    };
+    
+    // Structure-of-arrays vector: soa_vector<A, B, C> stores its rows as
+    // three columns, each an unchecked epl::vector, so a loop over one field
+    // reads only that field's memory.  Every row operation is applied to all
+    // columns, so they grow, recenter and shrink together through the
+    // vector's own check_back/check_front.  If a column throws part way
+    // through a push, the columns already pushed are popped again.
+    //
+    // Rows are exchanged as std::tuple<Ts...>; operator[] and iterators
+    // return std::tuple<Ts&...> proxies, so rows can be read and assigned in
+    // place but there is no operator->.  Iterators follow the vector's
+    // version checks under default_checking.
+    template <typename... Ts>
+    class soa_vector {
+        using columns_type = std::tuple<vector<Ts, unchecked>...>;
+        using indices = std::index_sequence_for<Ts...>;
+        
+        template <std::size_t I>
+        using column_type = typename std::tuple_element<I, std::tuple<Ts...>>::type;
+        
+        template <std::size_t I>
+        using at_column = std::integral_constant<std::size_t, I>;
+        using past_last_column = std::integral_constant<std::size_t, sizeof...(Ts)>;
+        
+        columns_type columns;
+        
+        size_t version = 0;
+        size_t resize_version = 0;
+    
+    public:
+        using value_type = std::tuple<Ts...>;
+        using reference = std::tuple<Ts&...>;
+        using const_reference = std::tuple<const Ts&...>;
+        using size_type = uint64_t;
+        using difference_type = std::ptrdiff_t;
+        
+        static constexpr std::size_t column_count = sizeof...(Ts);
+        
+        soa_vector(void) {
+        }
+        
+        soa_vector(std::initializer_list<value_type> il) {
+            reserve(il.size());
+            for (const value_type& row : il) { push_back(row); }
+        }
+        
+        uint64_t size(void) const {
+            return std::get<0>(columns).size();
+        }
+        
+        uint64_t capacity(void) const {
+            return std::get<0>(columns).capacity();
+        }
+        
+        reference operator[](uint64_t k) {
+            if (k >= size()) { throw std::out_of_range("index out of range"); }
+            return row(k, indices());
+        }
+        
+        const_reference operator[](uint64_t k) const {
+            if (k >= size()) { throw std::out_of_range("index out of range"); }
+            return row(k, indices());
+        }
+        
+        reference front(void) {
+            if (size() == 0) { throw std::out_of_range("empty Vector"); }
+            return row(0, indices());
+        }
+        
+        const_reference front(void) const {
+            if (size() == 0) { throw std::out_of_range("empty Vector"); }
+            return row(0, indices());
+        }
+        
+        reference back(void) {
+            if (size() == 0) { throw std::out_of_range("back called on empty Vector"); }
+            return row(size() - 1, indices());
+        }
+        
+        const_reference back(void) const {
+            if (size() == 0) { throw std::out_of_range("back called on empty Vector"); }
+            return row(size() - 1, indices());
+        }
+        
+        template <std::size_t I>
+        column_span<column_type<I>> column(void) {
+            return column_span<column_type<I>>(std::get<I>(columns).data(), size());
+        }
+        
+        template <std::size_t I>
+        column_span<const column_type<I>> column(void) const {
+            return column_span<const column_type<I>>(std::get<I>(columns).data(), size());
+        }
+        
+        void push_back(const value_type& that) { emplace_columns_back(that, at_column<0>()); modified(); }
+        void push_back(value_type&& that) { emplace_columns_back(std::move(that), at_column<0>()); modified(); }
+        
+        // one argument per column
+        template <typename... Args>
+        void emplace_back(Args&&... args) {
+            static_assert(sizeof...(Args) == sizeof...(Ts), "emplace_back takes one value per column");
+            emplace_columns_back(std::forward_as_tuple(std::forward<Args>(args)...), at_column<0>());
+            modified();
+        }
+        
+        void push_front(const value_type& that) { emplace_columns_front(that, at_column<0>()); modified(); }
+        void push_front(value_type&& that) { emplace_columns_front(std::move(that), at_column<0>()); modified(); }
+        
+        template <typename... Args>
+        void emplace_front(Args&&... args) {
+            static_assert(sizeof...(Args) == sizeof...(Ts), "emplace_front takes one value per column");
+            emplace_columns_front(std::forward_as_tuple(std::forward<Args>(args)...), at_column<0>());
+            modified();
+        }
+        
+        void pop_back(void) {
+            modified();
+            if (size() == 0) { throw std::out_of_range("empty vector, nothing to pop back"); }
+            pop_columns_back(indices());
+        }
+        
+        void pop_front(void) {
+            modified();
+            if (size() == 0) { throw std::out_of_range("empty vector, nothing to pop front"); }
+            pop_columns_front(indices());
+        }
+        
+        void reserve(uint64_t n) {
+            watch_storage([&] { reserve_columns(n, indices()); });
+        }
+        
+        void reserve_front(uint64_t n) {
+            watch_storage([&] { reserve_columns_front(n, indices()); });
+        }
+        
+        /*****************************************************************************************/
+        // Iterators
+        /*****************************************************************************************/
+        template <bool Const>
+        class basic_iterator {
+            using container = typename std::conditional<Const, const soa_vector, soa_vector>::type;
+            
+            container* obj;
+            
+            size_t version;
+            size_t resize_version;
+            uint64_t index;
+            bool valid;
+        
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = std::tuple<Ts...>;
+            using difference_type = std::ptrdiff_t;
+            using reference = typename std::conditional<Const, const_reference, soa_vector::reference>::type;
+            using pointer = void;
+            
+            basic_iterator(void) : obj(nullptr), version(0), resize_version(0), index(0), valid(true) {}
+            
+            template <bool C = Const, typename = typename std::enable_if<C>::type>
+            basic_iterator(const basic_iterator<false>& that) :
+            obj(that.obj), version(that.version), resize_version(that.resize_version), index(that.index), valid(that.valid) {}
+            
+            reference operator*(void) const {
+                validate(this);
+                return obj->row(index, indices());
+            }
+            
+            reference operator[](difference_type k) const { return *(*this + k); }
+            
+            basic_iterator& operator++(void) { return *this += 1; }
+            basic_iterator operator++(int) { basic_iterator tmp(*this); *this += 1; return tmp; }
+            basic_iterator& operator--(void) { return *this -= 1; }
+            basic_iterator operator--(int) { basic_iterator tmp(*this); *this -= 1; return tmp; }
+            
+            basic_iterator& operator+=(difference_type k) {
+                validate(this);
+                index += k;
+                valid = (index < obj->size());
+                return *this;
+            }
+            
+            basic_iterator& operator-=(difference_type k) { return *this += -k; }
+            basic_iterator operator+(difference_type k) const { basic_iterator tmp(*this); return tmp += k; }
+            basic_iterator operator-(difference_type k) const { basic_iterator tmp(*this); return tmp -= k; }
+            friend basic_iterator operator+(difference_type k, const basic_iterator& it) { return it + k; }
+            
+            difference_type operator-(const basic_iterator& that) const {
+                validate(this);
+                validate(&that);
+                return index - that.index;
+            }
+            
+            bool operator==(const basic_iterator& that) const {
+                validate(this);
+                validate(&that);
+                return index == that.index;
+            }
+            
+            bool operator!=(const basic_iterator& that) const { return ! (*this == that); }
+            
+            bool operator<(const basic_iterator& that) const {
+                validate(this);
+                validate(&that);
+                return index < that.index;
+            }
+            
+            bool operator>(const basic_iterator& that) const { return that < *this; }
+            bool operator<=(const basic_iterator& that) const { return ! (that < *this); }
+            bool operator>=(const basic_iterator& that) const { return ! (*this < that); }
+            
+            friend soa_vector;
+            friend class basic_iterator<true>;
+        
+        private:
+            basic_iterator(container* obj, uint64_t index) :
+            obj(obj), version(obj->version), resize_version(obj->resize_version), index(index), valid(index < obj->size()) {}
+            
+            void validate(const basic_iterator* iter) const {
+                if (! default_checking::enabled) { return; }
+                if ((iter->version != iter->obj->version) || (iter->resize_version != iter->obj->resize_version)) {
+                    invalid_iterator::SeverityLevel level;
+                    if (iter->valid && (iter->index >= iter->obj->size()))
+                    { level = epl::invalid_iterator::SEVERE; }
+                    else if (iter->valid && (iter->resize_version != iter->obj->resize_version))
+                    { level = epl::invalid_iterator::MODERATE; }
+                    else
+                    { level = epl::invalid_iterator::MILD; }
+                    throw epl::invalid_iterator{ level };
+                }
+            }
+        };
+        
+        using iterator = basic_iterator<false>;
+        using const_iterator = basic_iterator<true>;
+        
+        iterator begin(void) { return iterator(this, 0); }
+        iterator end(void) { return iterator(this, size()); }
+        const_iterator begin(void) const { return const_iterator(this, 0); }
+        const_iterator end(void) const { return const_iterator(this, size()); }
+        const_iterator cbegin(void) const { return begin(); }
+        const_iterator cend(void) const { return end(); }
+    
+    private:
+        void modified(void) { if (default_checking::enabled) { ++version; } }
+        void resized(void) { if (default_checking::enabled) { ++resize_version; } }
+        
+        template <std::size_t... I>
+        reference row(uint64_t k, std::index_sequence<I...>) {
+            return reference(std::get<I>(columns).data()[k]...);
+        }
+        
+        template <std::size_t... I>
+        const_reference row(uint64_t k, std::index_sequence<I...>) const {
+            return const_reference(std::get<I>(columns).data()[k]...);
+        }
+        
+        // the storage moved, as seen from the first column
+        template <typename F>
+        void watch_storage(F f) {
+            const void* before = std::get<0>(columns).data();
+            f();
+            if (std::get<0>(columns).data() != before) { resized(); }
+        }
+        
+        template <typename Row>
+        void emplace_columns_back(Row&&, past_last_column) {}
+        
+        template <typename Row, std::size_t I>
+        void emplace_columns_back(Row&& r, at_column<I>) {
+            if (I == 0) {
+                watch_storage([&] { std::get<0>(columns).emplace_back(std::get<0>(std::forward<Row>(r))); });
+            } else {
+                std::get<I>(columns).emplace_back(std::get<I>(std::forward<Row>(r)));
+            }
+            try {
+                emplace_columns_back(std::forward<Row>(r), at_column<I + 1>());
+            } catch (...) {
+                std::get<I>(columns).pop_back();
+                throw;
+            }
+        }
+        
+        template <typename Row>
+        void emplace_columns_front(Row&&, past_last_column) {}
+        
+        template <typename Row, std::size_t I>
+        void emplace_columns_front(Row&& r, at_column<I>) {
+            if (I == 0) {
+                watch_storage([&] { std::get<0>(columns).emplace_front(std::get<0>(std::forward<Row>(r))); });
+            } else {
+                std::get<I>(columns).emplace_front(std::get<I>(std::forward<Row>(r)));
+            }
+            try {
+                emplace_columns_front(std::forward<Row>(r), at_column<I + 1>());
+            } catch (...) {
+                std::get<I>(columns).pop_front();
+                throw;
+            }
+        }
+        
+        template <std::size_t... I>
+        void pop_columns_back(std::index_sequence<I...>) {
+            (void) std::initializer_list<int>{ (std::get<I>(columns).pop_back(), 0)... };
+        }
+        
+        template <std::size_t... I>
+        void pop_columns_front(std::index_sequence<I...>) {
+            (void) std::initializer_list<int>{ (std::get<I>(columns).pop_front(), 0)... };
+        }
+        
+        template <std::size_t... I>
+        void reserve_columns(uint64_t n, std::index_sequence<I...>) {
+            (void) std::initializer_list<int>{ (std::get<I>(columns).reserve(n), 0)... };
+        }
+        
+        template <std::size_t... I>
+        void reserve_columns_front(uint64_t n, std::index_sequence<I...>) {
+            (void) std::initializer_list<int>{ (std::get<I>(columns).reserve_front(n), 0)... };
+        }
+    };
+    
+} //namespace epl
+
+#endif
@@ -0,0 +1,296 @@
+#ifndef _SORT_H_
+#define _SORT_H_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Parallel.h"
+#include "Vector.h"
+
+// epl::sort and epl::sort_by_key for whole epl::vectors.  The algorithm is
+// picked at compile time from the key type:
+//
+//   - integral (other than bool) and float/double keys, whether the elements
+//     themselves or a projection of trivially copyable elements, go to an
+//     LSD radix sort, one byte per pass.  All byte histograms come from a
+//     single read of the input, and passes in which every key has the same
+//     byte are skipped, so narrow key ranges cost fewer passes.  The scatter
+//     target is a per-thread scratch buffer that is kept between calls.
+//   - everything else, and any call with a comparator, goes to std::sort on
+//     the raw buffer, so checked iterators are validated once and not on
+//     every comparison.
+//
+// The overloads taking a thread_pool run multithreaded once the vector holds
+// at least parallel_sort_threshold elements: the radix passes histogram and
+// scatter one slice per thread, and comparison sorts use parallel::sort.
+//
+// Floating-point keys are ordered by their bits: -0.0 comes before 0.0 and
+// NaNs go to the ends according to their sign.  The radix sort is stable;
+// the comparison sort is not, so neither entry point promises stability.
+
+namespace epl{
+    
+    const uint64_t parallel_sort_threshold = 1 << 16;
+    
+    namespace detail {
+        // maps a key to an unsigned integer with the same order
+        template <typename K, typename = void>
+        struct radix_key {
+            static const bool enabled = false;
+        };
+        
+        template <typename K>
+        struct radix_key<K, typename std::enable_if<std::is_integral<K>::value && !std::is_same<K, bool>::value>::type> {
+            static const bool enabled = true;
+            using bits_type = typename std::make_unsigned<K>::type;
+            
+            static bits_type encode(K k) {
+                const bits_type sign = std::is_signed<K>::value ? bits_type(1) << (8 * sizeof(K) - 1) : 0;
+                return static_cast<bits_type>(k) ^ sign;
+            }
+        };
+        
+        template <typename K>
+        struct radix_key<K, typename std::enable_if<std::is_floating_point<K>::value && (sizeof(K) == 4 || sizeof(K) == 8)>::type> {
+            static const bool enabled = true;
+            using bits_type = typename std::conditional<sizeof(K) == 4, uint32_t, uint64_t>::type;
+            
+            // negative values have their order reversed by flipping every bit
+            static bits_type encode(K k) {
+                bits_type b;
+                std::memcpy(&b, &k, sizeof(b));
+                const bits_type sign = bits_type(1) << (8 * sizeof(K) - 1);
+                return (b & sign) ? ~b : (b | sign);
+            }
+        };
+        
+        struct identity_projection {
+            template <typename T>
+            const T& operator()(const T& v) const { return v; }
+        };
+        
+        template <typename T, typename Key>
+        using projected_key = typename std::decay<decltype(std::declval<Key&>()(std::declval<const T&>()))>::type;
+        
+        template <typename T, typename Key>
+        using radix_sortable = std::integral_constant<bool, radix_key<projected_key<T, Key>>::enabled && std::is_trivially_copyable<T>::value>;
+        
+        // below this many elements per key byte a comparison sort wins over
+        // the passes
+        const uint64_t radix_minimum = 256;
+        
+        // Scatter target of the radix sort.  There is one per thread; it
+        // grows to the largest sort run on that thread and is kept for the
+        // next one until release_sort_scratch.
+        struct sort_scratch {
+            std::unique_ptr<unsigned char[]> bytes;
+            uint64_t size = 0;
+        };
+        
+        inline sort_scratch& thread_sort_scratch(void) {
+            static thread_local sort_scratch scratch;
+            return scratch;
+        }
+        
+        template <typename T>
+        T* scratch_for(uint64_t n) {
+            sort_scratch& scratch = thread_sort_scratch();
+            const uint64_t needed = n * sizeof(T) + alignof(T);
+            if (scratch.size < needed) {
+                scratch.bytes.reset(); // let go of the old buffer before asking for a bigger one
+                scratch.size = 0;
+                scratch.bytes.reset(new unsigned char[needed]);
+                scratch.size = needed;
+            }
+            void* p = scratch.bytes.get();
+            std::size_t space = needed;
+            return static_cast<T*>(std::align(alignof(T), n * sizeof(T), p, space));
+        }
+        
+        template <typename T, typename Key>
+        typename radix_key<projected_key<T, Key>>::bits_type radix_bits(const T& v, Key& key) {
+            return radix_key<projected_key<T, Key>>::encode(key(v));
+        }
+        
+        template <typename T, typename Key>
+        void comparison_sort(T* data, uint64_t n, Key& key) {
+            std::sort(data, data + n, [&key](const T& a, const T& b) { return key(a) < key(b); });
+        }
+        
+        // small radix-sortable inputs: ordered by the same encoded bits as the
+        // passes, so floats keep the documented order for NaNs and zeros
+        // whatever n is, and NaNs do not break std::sort's strict weak ordering
+        template <typename T, typename Key>
+        void encoded_sort(T* data, uint64_t n, Key& key) {
+            std::sort(data, data + n, [&key](const T& a, const T& b) { return radix_bits(a, key) < radix_bits(b, key); });
+        }
+        
+        template <typename T, typename Key>
+        void radix_sort(T* data, uint64_t n, Key& key) {
+            using bits_type = typename radix_key<projected_key<T, Key>>::bits_type;
+            const unsigned passes = sizeof(bits_type);
+            if (n < radix_minimum * passes) {
+                encoded_sort(data, n, key);
+                return;
+            }
+            
+            std::vector<std::array<uint64_t, 256>> counts(passes);
+            for (std::array<uint64_t, 256>& c : counts) { c.fill(0); }
+            for (uint64_t k = 0; k < n; ++k) {
+                const bits_type b = radix_bits(data[k], key);
+                for (unsigned p = 0; p < passes; ++p) { ++counts[p][(b >> (8 * p)) & 0xff]; }
+            }
+            
+            T* from = data;
+            T* to = scratch_for<T>(n);
+            for (unsigned p = 0; p < passes; ++p) {
+                std::array<uint64_t, 256>& offset = counts[p];
+                if (offset[(radix_bits(from[0], key) >> (8 * p)) & 0xff] == n) { continue; }
+                uint64_t sum = 0;
+                for (uint64_t& c : offset) { uint64_t count = c; c = sum; sum += count; }
+                for (uint64_t k = 0; k < n; ++k) {
+                    to[offset[(radix_bits(from[k], key) >> (8 * p)) & 0xff]++] = from[k];
+                }
+                std::swap(from, to);
+            }
+            if (from != data) { std::memcpy(static_cast<void*>(data), static_cast<const void*>(from), n * sizeof(T)); }
+        }
+        
+        // Each pass histograms one slice per thread, turns the histograms
+        // into per-slice write offsets (digit-major, slice-minor, which keeps
+        // the scatter stable) and scatters the slices in parallel.
+        template <typename T, typename Key>
+        void parallel_radix_sort(thread_pool& pool, T* data, uint64_t n, Key& key) {
+            using bits_type = typename radix_key<projected_key<T, Key>>::bits_type;
+            const unsigned passes = sizeof(bits_type);
+            const uint64_t slices = pool.size();
+            std::vector<std::array<uint64_t, 256>> counts(slices);
+            
+            T* from = data;
+            T* to = scratch_for<T>(n);
+            for (unsigned p = 0; p < passes; ++p) {
+                const unsigned shift = 8 * p;
+                {
+                    task_group group(pool);
+                    for (uint64_t s = 0; s < slices; ++s) {
+                        group.run([=, &counts, &key] {
+                            std::array<uint64_t, 256>& c = counts[s];
+                            c.fill(0);
+                            for (uint64_t k = n * s / slices; k < n * (s + 1) / slices; ++k) {
+                                ++c[(radix_bits(from[k], key) >> shift) & 0xff];
+                            }
+                        });
+                    }
+                    group.wait();
+                }
+                
+                const unsigned first_digit = (radix_bits(from[0], key) >> shift) & 0xff;
+                uint64_t same = 0;
+                for (uint64_t s = 0; s < slices; ++s) { same += counts[s][first_digit]; }
+                if (same == n) { continue; }
+                
+                uint64_t sum = 0;
+                for (unsigned d = 0; d < 256; ++d) {
+                    for (uint64_t s = 0; s < slices; ++s) {
+                        uint64_t count = counts[s][d];
+                        counts[s][d] = sum;
+                        sum += count;
+                    }
+                }
+                {
+                    task_group group(pool);
+                    for (uint64_t s = 0; s < slices; ++s) {
+                        group.run([=, &counts, &key] {
+                            std::array<uint64_t, 256>& offset = counts[s];
+                            for (uint64_t k = n * s / slices; k < n * (s + 1) / slices; ++k) {
+                                to[offset[(radix_bits(from[k], key) >> shift) & 0xff]++] = from[k];
+                            }
+                        });
+                    }
+                    group.wait();
+                }
+                std::swap(from, to);
+            }
+            if (from != data) {
+                for_each_chunk(pool, data, n, [=](uint64_t lo, uint64_t hi) {
+                    std::memcpy(static_cast<void*>(data + lo), static_cast<const void*>(from + lo), (hi - lo) * sizeof(T));
+                });
+            }
+        }
+        
+        template <typename T, typename Key>
+        void sort_dispatch(thread_pool* pool, T* data, uint64_t n, Key& key, std::true_type) {
+            if (pool != nullptr && pool->size() > 1 && n >= parallel_sort_threshold) {
+                parallel_radix_sort(*pool, data, n, key);
+            } else {
+                radix_sort(data, n, key);
+            }
+        }
+        
+        template <typename T, typename Key>
+        void sort_dispatch(thread_pool* pool, T* data, uint64_t n, Key& key, std::false_type) {
+            if (pool != nullptr && n >= parallel_sort_threshold) {
+                parallel::sort(*pool, data, data + n, [&key](const T& a, const T& b) { return key(a) < key(b); });
+            } else {
+                comparison_sort(data, n, key);
+            }
+        }
+    }
+    
+    // frees the calling thread's radix scratch buffer
+    inline void release_sort_scratch(void) {
+        detail::sort_scratch& scratch = detail::thread_sort_scratch();
+        scratch.bytes.reset();
+        scratch.size = 0;
+    }
+    
+    template <typename T, typename C, typename A, std::size_t N, typename G>
+    void sort(vector<T, C, A, N, G>& v) {
+        detail::identity_projection key;
+        detail::sort_dispatch(nullptr, v.data(), v.size(), key, detail::radix_sortable<T, detail::identity_projection>{});
+    }
+    
+    template <typename T, typename C, typename A, std::size_t N, typename G>
+    void sort(thread_pool& pool, vector<T, C, A, N, G>& v) {
+        detail::identity_projection key;
+        detail::sort_dispatch(&pool, v.data(), v.size(), key, detail::radix_sortable<T, detail::identity_projection>{});
+    }
+    
+    template <typename T, typename C, typename A, std::size_t N, typename G, typename Compare>
+    void sort(vector<T, C, A, N, G>& v, Compare comp) {
+        T* data = v.data();
+        std::sort(data, data + v.size(), comp);
+    }
+    
+    template <typename T, typename C, typename A, std::size_t N, typename G, typename Compare>
+    void sort(thread_pool& pool, vector<T, C, A, N, G>& v, Compare comp) {
+        T* data = v.data();
+        if (v.size() >= parallel_sort_threshold) {
+            parallel::sort(pool, data, data + v.size(), comp);
+        } else {
+            std::sort(data, data + v.size(), comp);
+        }
+    }
+    
+    // orders the elements by key(element) < key(element)
+    template <typename T, typename C, typename A, std::size_t N, typename G, typename Key>
+    void sort_by_key(vector<T, C, A, N, G>& v, Key key) {
+        detail::sort_dispatch(nullptr, v.data(), v.size(), key, detail::radix_sortable<T, Key>{});
+    }
+    
+    template <typename T, typename C, typename A, std::size_t N, typename G, typename Key>
+    void sort_by_key(thread_pool& pool, vector<T, C, A, N, G>& v, Key key) {
+        detail::sort_dispatch(&pool, v.data(), v.size(), key, detail::radix_sortable<T, Key>{});
+    }
+    
+} //namespace epl
+
+#endif
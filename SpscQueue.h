@@ -0,0 +1,258 @@
+#ifndef _SPSC_QUEUE_H_
+#define _SPSC_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace epl{
+    
+    // Lock-free queue between exactly one producer thread and one consumer
+    // thread: the producer calls the push functions, the consumer the pop
+    // functions, and neither needs a lock.
+    //
+    // Elements live in a ring with an atomic head (advanced by the consumer,
+    // like data_start on pop_front) and tail (advanced by the producer, like
+    // data_end on push_back).  Each side keeps a cached copy of the other
+    // side's index and reloads it only when the ring looks full or empty, and
+    // the two sides' state sits on separate cache lines.
+    //
+    // try_push fails when the ring is full, giving a fixed-capacity queue.
+    // push never fails: when the ring is full the producer links a ring of
+    // twice the capacity after it and continues there, and the consumer frees
+    // the old ring once it has drained it.  Since the producer never touches
+    // the rings behind it, the queue-wide counts of pushed and popped
+    // elements are kept apart from the rings, so that size() can be called
+    // from either thread.
+    template <typename T, typename Alloc = std::allocator<T>>
+    class spsc_queue {
+        using alloc_traits = std::allocator_traits<Alloc>;
+        
+        struct ring {
+            alignas(64) std::atomic<uint64_t> head; // consumer side
+            uint64_t cached_tail;
+            
+            alignas(64) std::atomic<uint64_t> tail; // producer side
+            uint64_t cached_head;
+            
+            alignas(64) std::atomic<ring*> next; // written once, by the producer
+            T* slots;
+            uint64_t mask;
+            
+            explicit ring(T* slots, uint64_t capacity) : head(0), cached_tail(0), tail(0), cached_head(0), next(nullptr), slots(slots), mask(capacity - 1) {}
+        };
+        
+        Alloc alloc;
+        alignas(64) ring* head_ring; // consumer only
+        std::atomic<uint64_t> popped;
+        alignas(64) ring* tail_ring; // producer only
+        std::atomic<uint64_t> pushed;
+    
+    public:
+        static const uint64_t minimum_capacity = 16;
+        
+        // capacity is rounded up to a power of two
+        explicit spsc_queue(uint64_t capacity = 1024, const Alloc& alloc = Alloc()) : alloc(alloc), popped(0), pushed(0) {
+            uint64_t cap = minimum_capacity;
+            while (cap < capacity) { cap *= 2; }
+            head_ring = tail_ring = make_ring(cap);
+        }
+        
+        spsc_queue(const spsc_queue&) = delete;
+        spsc_queue& operator=(const spsc_queue&) = delete;
+        
+        // neither thread may be using the queue any more
+        ~spsc_queue(void) {
+            ring* r = head_ring;
+            while (r != nullptr) {
+                const uint64_t tail = r->tail.load(std::memory_order_relaxed);
+                for (uint64_t k = r->head.load(std::memory_order_relaxed); k != tail; ++k) {
+                    alloc_traits::destroy(alloc, r->slots + (k & r->mask));
+                }
+                ring* next = r->next.load(std::memory_order_relaxed);
+                free_ring(r);
+                r = next;
+            }
+        }
+        
+        /*****************************************************************************************/
+        // Producer
+        /*****************************************************************************************/
+        template <typename... Args>
+        bool try_emplace(Args&&... args) {
+            ring* r = tail_ring;
+            const uint64_t tail = r->tail.load(std::memory_order_relaxed);
+            if (tail - r->cached_head > r->mask) {
+                r->cached_head = r->head.load(std::memory_order_acquire);
+                if (tail - r->cached_head > r->mask) { return false; }
+            }
+            alloc_traits::construct(alloc, r->slots + (tail & r->mask), std::forward<Args>(args)...);
+            publish(r, tail, 1);
+            return true;
+        }
+        
+        bool try_push(const T& v) { return try_emplace(v); }
+        bool try_push(T&& v) { return try_emplace(std::move(v)); }
+        
+        template <typename... Args>
+        void emplace(Args&&... args) {
+            if (! try_emplace(std::forward<Args>(args)...)) {
+                grow();
+                try_emplace(std::forward<Args>(args)...);
+            }
+        }
+        
+        void push(const T& v) { emplace(v); }
+        void push(T&& v) { emplace(std::move(v)); }
+        
+        // pushes as many of [first, last) as fit with one release of the tail;
+        // returns the number pushed.  If copying an element throws, the ones
+        // before it stay pushed.  The range is measured before it is copied,
+        // so it must be a forward range.
+        template <typename It>
+        uint64_t try_push(It first, It last) {
+            static_assert(std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<It>::iterator_category>::value,
+                          "try_push needs forward iterators");
+            ring* r = tail_ring;
+            const uint64_t tail = r->tail.load(std::memory_order_relaxed);
+            uint64_t room = r->mask + 1 - (tail - r->cached_head);
+            if (room == 0 || (uint64_t) std::distance(first, last) > room) {
+                r->cached_head = r->head.load(std::memory_order_acquire);
+                room = r->mask + 1 - (tail - r->cached_head);
+            }
+            uint64_t n = 0;
+            try {
+                for (; n < room && first != last; ++n, ++first) {
+                    alloc_traits::construct(alloc, r->slots + ((tail + n) & r->mask), *first);
+                }
+            } catch (...) {
+                publish(r, tail, n);
+                throw;
+            }
+            publish(r, tail, n);
+            return n;
+        }
+        
+        template <typename It>
+        void push(It first, It last) {
+            for (;;) {
+                const uint64_t n = try_push(first, last);
+                std::advance(first, n);
+                if (first == last) { return; }
+                grow();
+            }
+        }
+        
+        /*****************************************************************************************/
+        // Consumer
+        /*****************************************************************************************/
+        bool try_pop(T& out) {
+            ring* r = readable_ring();
+            if (r == nullptr) { return false; }
+            const uint64_t head = r->head.load(std::memory_order_relaxed);
+            T* slot = r->slots + (head & r->mask);
+            out = std::move(*slot);
+            alloc_traits::destroy(alloc, slot);
+            release(r, head, 1);
+            return true;
+        }
+        
+        // pops up to max elements into out with one release of the head;
+        // returns the number popped
+        template <typename OutputIt>
+        uint64_t try_pop(OutputIt out, uint64_t max) {
+            uint64_t n = 0;
+            while (n < max) {
+                ring* r = readable_ring();
+                if (r == nullptr) { break; }
+                const uint64_t head = r->head.load(std::memory_order_relaxed);
+                uint64_t k = 0;
+                for (; k < max - n && head + k != r->cached_tail; ++k, ++out) {
+                    T* slot = r->slots + ((head + k) & r->mask);
+                    *out = std::move(*slot);
+                    alloc_traits::destroy(alloc, slot);
+                }
+                release(r, head, k);
+                n += k;
+            }
+            return n;
+        }
+        
+        bool empty(void) { return readable_ring() == nullptr; }
+        
+        // Callable from either thread: exact when the other side is idle, a
+        // snapshot otherwise.  The producer counts an element in pushed
+        // before releasing it through the tail, so popped never passes
+        // pushed; popped is read first, so the difference never goes
+        // negative.
+        uint64_t size(void) const {
+            const uint64_t out = popped.load(std::memory_order_acquire);
+            return pushed.load(std::memory_order_acquire) - out;
+        }
+        
+        // producer: capacity of the ring it is writing to
+        uint64_t capacity(void) const { return tail_ring->mask + 1; }
+    
+    private:
+        ring* make_ring(uint64_t capacity) {
+            T* slots = alloc_traits::allocate(alloc, capacity);
+            try {
+                return new ring(slots, capacity);
+            } catch (...) {
+                alloc_traits::deallocate(alloc, slots, capacity);
+                throw;
+            }
+        }
+        
+        void free_ring(ring* r) {
+            alloc_traits::deallocate(alloc, r->slots, r->mask + 1);
+            delete r;
+        }
+        
+        // producer: makes n constructed elements from tail on visible,
+        // counting them in pushed before the consumer can pop them
+        void publish(ring* r, uint64_t tail, uint64_t n) {
+            pushed.store(pushed.load(std::memory_order_relaxed) + n, std::memory_order_release);
+            r->tail.store(tail + n, std::memory_order_release);
+        }
+        
+        // consumer: hands n destroyed slots from head on back to the producer
+        void release(ring* r, uint64_t head, uint64_t n) {
+            r->head.store(head + n, std::memory_order_release);
+            popped.store(popped.load(std::memory_order_relaxed) + n, std::memory_order_release);
+        }
+        
+        // producer: nothing is written to the old ring after next is published
+        void grow(void) {
+            ring* r = make_ring(2 * (tail_ring->mask + 1));
+            tail_ring->next.store(r, std::memory_order_release);
+            tail_ring = r;
+        }
+        
+        // consumer: the ring holding the front element, or nullptr when the
+        // queue is empty; drained rings that have a successor are freed
+        ring* readable_ring(void) {
+            for (;;) {
+                ring* r = head_ring;
+                const uint64_t head = r->head.load(std::memory_order_relaxed);
+                if (head != r->cached_tail) { return r; }
+                r->cached_tail = r->tail.load(std::memory_order_acquire);
+                if (head != r->cached_tail) { return r; }
+                ring* next = r->next.load(std::memory_order_acquire);
+                if (next == nullptr) { return nullptr; }
+                // the tail is final once next is visible
+                r->cached_tail = r->tail.load(std::memory_order_acquire);
+                if (head != r->cached_tail) { return r; }
+                head_ring = next;
+                free_ring(r);
+            }
+        }
+    };
+    
+} //namespace epl
+
+#endif
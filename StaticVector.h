@@ -0,0 +1,449 @@
+#ifndef _STATIC_VECTOR_H_
+#define _STATIC_VECTOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "Vector.h"
+
+namespace epl{
+    
+    // Error policies for static_vector.  overflow is called when a push
+    // finds all N slots taken, out_of_range for a bad index or an empty
+    // front/back/pop.  Neither may return.
+    struct throw_on_error {
+        [[noreturn]] static void overflow(const char* what) { throw std::length_error(what); }
+        [[noreturn]] static void out_of_range(const char* what) { throw std::out_of_range(what); }
+    };
+    
+    // for code built without exceptions
+    struct abort_on_error {
+        [[noreturn]] static void overflow(const char*) { std::abort(); }
+        [[noreturn]] static void out_of_range(const char*) { std::abort(); }
+    };
+    
+    namespace detail {
+        // Slots that always hold a T can be used in constant expressions:
+        // construction is assignment and destruction is a no-op.  Constant
+        // evaluation needs every slot initialized, but zeroing N slots on
+        // each construction at run time would cost O(N), so where the
+        // compiler can tell the two apart only constant evaluation zeroes.
+        template <typename T>
+        struct is_literal_slot : std::integral_constant<bool,
+            std::is_default_constructible<T>::value && std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value> {};
+        
+        template <typename T, std::size_t N, bool Literal = is_literal_slot<T>::value>
+        class static_storage;
+        
+        template <typename T, std::size_t N>
+        class static_storage<T, N, true> {
+#ifdef __cpp_lib_is_constant_evaluated
+            T slots[N];
+#else
+            T slots[N]{};
+#endif
+        
+        protected:
+            uint64_t first = N / 2;
+            uint64_t count = 0;
+            
+#ifdef __cpp_lib_is_constant_evaluated
+            constexpr static_storage(void) {
+                if (std::is_constant_evaluated()) {
+                    for (std::size_t k = 0; k < N; ++k) { slots[k] = T(); }
+                }
+            }
+#endif
+            
+            constexpr T* slot(uint64_t k) { return slots + k; }
+            constexpr const T* slot(uint64_t k) const { return slots + k; }
+            
+            template <typename... Args>
+            constexpr void construct(uint64_t k, Args&&... args) { slots[k] = T(std::forward<Args>(args)...); }
+            constexpr void destroy(uint64_t) {}
+            
+            // moves the n elements at from to to; the ranges may overlap
+            constexpr void slide(uint64_t from, uint64_t to, uint64_t n) {
+                if (to < from) {
+                    for (uint64_t k = 0; k < n; ++k) { slots[to + k] = slots[from + k]; }
+                } else {
+                    for (uint64_t k = n; k > 0; --k) { slots[to + k - 1] = slots[from + k - 1]; }
+                }
+            }
+        };
+        
+        // everything else is built and destroyed in raw storage
+        template <typename T, std::size_t N>
+        class static_storage<T, N, false> {
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type raw[N];
+        
+        protected:
+            uint64_t first = N / 2;
+            uint64_t count = 0;
+            
+            static_storage(void) {}
+            
+            static_storage(const static_storage& that) : first(that.first) {
+                append_from(that);
+            }
+            
+            static_storage(static_storage&& that) : first(that.first) {
+                append_from(std::move(that));
+            }
+            
+            static_storage& operator=(const static_storage& that) {
+                if (this != &that) {
+                    clear();
+                    first = that.first;
+                    append_from(that);
+                }
+                return *this;
+            }
+            
+            static_storage& operator=(static_storage&& that) {
+                if (this != &that) {
+                    clear();
+                    first = that.first;
+                    append_from(std::move(that));
+                }
+                return *this;
+            }
+            
+            ~static_storage(void) {
+                clear();
+            }
+            
+            T* slot(uint64_t k) { return reinterpret_cast<T*>(raw + k); }
+            const T* slot(uint64_t k) const { return reinterpret_cast<const T*>(raw + k); }
+            
+            template <typename... Args>
+            void construct(uint64_t k, Args&&... args) { ::new (static_cast<void*>(slot(k))) T(std::forward<Args>(args)...); }
+            void destroy(uint64_t k) { slot(k)->~T(); }
+            
+            void slide(uint64_t from, uint64_t to, uint64_t n) {
+                if (to < from) {
+                    for (uint64_t k = 0; k < n; ++k) { construct(to + k, std::move(*slot(from + k))); destroy(from + k); }
+                } else {
+                    for (uint64_t k = n; k > 0; --k) { construct(to + k - 1, std::move(*slot(from + k - 1))); destroy(from + k - 1); }
+                }
+            }
+        
+        private:
+            void clear(void) {
+                for (; count != 0; --count) { destroy(first + count - 1); }
+            }
+            
+            // count is kept up to date, so a throwing constructor leaves a
+            // valid (shorter) vector behind
+            template <typename Storage>
+            void append_from(Storage&& that) {
+                for (uint64_t k = 0; k < that.count; ++k) {
+                    if (std::is_rvalue_reference<Storage&&>::value) {
+                        construct(first + k, std::move(*that.slot(that.first + k)));
+                    } else {
+                        construct(first + k, *that.slot(that.first + k));
+                    }
+                    ++count;
+                }
+            }
+        };
+    }
+    
+    // Fixed-capacity vector that keeps its N slots inside the object and
+    // never allocates.  It has the double-ended interface of epl::vector:
+    // the elements start in the middle, and when one end runs out of room
+    // while the other has some they are slid over, as vector recenters.  A
+    // push onto a full vector goes to ErrorPolicy::overflow.
+    //
+    // For types that are default constructible, trivially copyable and
+    // trivially destructible every slot holds a value, and the whole
+    // interface is constexpr, so tables can be built at compile time:
+    //
+    //     constexpr auto squares = [] {
+    //         static_vector<int, 16> v;
+    //         for (int k = 0; k < 16; ++k) { v.push_back(k * k); }
+    //         return v;
+    //     }();
+    //
+    // Other types live in raw storage and are built and destroyed in place.
+    template <typename T, std::size_t N, typename Checking = default_checking, typename ErrorPolicy = throw_on_error>
+    class static_vector : private detail::static_storage<T, N> {
+        static_assert(N > 0, "static_vector needs at least one slot");
+        
+        using storage = detail::static_storage<T, N>;
+        using storage::first;
+        using storage::count;
+        using storage::slot;
+        using storage::construct;
+        using storage::destroy;
+        using storage::slide;
+        
+        size_t version = 0;
+        size_t resize_version = 0;
+    
+    public:
+        using value_type = T;
+        using reference = T&;
+        using const_reference = const T&;
+        using size_type = uint64_t;
+        using difference_type = std::ptrdiff_t;
+        
+        constexpr static_vector(void) {}
+        
+        constexpr static_vector(std::initializer_list<T> il) {
+            if (il.size() > N) { ErrorPolicy::overflow("initializer list longer than static_vector capacity"); }
+            first = (N - il.size()) / 2;
+            for (const T& v : il) {
+                construct(first + count, v);
+                ++count;
+            }
+        }
+        
+        static_vector(const static_vector&) = default;
+        static_vector(static_vector&&) = default;
+        
+        constexpr static_vector& operator=(const static_vector& rhs) {
+            storage::operator=(rhs);
+            modified();
+            resized();
+            return *this;
+        }
+        
+        constexpr static_vector& operator=(static_vector&& rhs) {
+            storage::operator=(std::move(rhs));
+            modified();
+            resized();
+            return *this;
+        }
+        
+        constexpr uint64_t size(void) const { return count; }
+        static constexpr uint64_t capacity(void) { return N; }
+        
+        constexpr T* data(void) { return slot(first); }
+        constexpr const T* data(void) const { return slot(first); }
+        
+        constexpr T& operator[](uint64_t k) {
+            if (k >= count) { ErrorPolicy::out_of_range("index out of range"); }
+            return *slot(first + k);
+        }
+        
+        constexpr const T& operator[](uint64_t k) const {
+            if (k >= count) { ErrorPolicy::out_of_range("index out of range"); }
+            return *slot(first + k);
+        }
+        
+        constexpr T& front(void) {
+            if (count == 0) { ErrorPolicy::out_of_range("empty Vector"); }
+            return *slot(first);
+        }
+        
+        constexpr const T& front(void) const {
+            if (count == 0) { ErrorPolicy::out_of_range("empty Vector"); }
+            return *slot(first);
+        }
+        
+        constexpr T& back(void) {
+            if (count == 0) { ErrorPolicy::out_of_range("back called on empty Vector"); }
+            return *slot(first + count - 1);
+        }
+        
+        constexpr const T& back(void) const {
+            if (count == 0) { ErrorPolicy::out_of_range("back called on empty Vector"); }
+            return *slot(first + count - 1);
+        }
+        
+        constexpr void push_back(const T& that) { emplace_back(that); }
+        constexpr void push_back(T&& that) { emplace_back(std::move(that)); }
+        
+        // the argument is built into its slot directly; a temporary is only
+        // needed when the room is made by sliding, which may move the
+        // element the arguments refer to
+        template <typename... Args>
+        constexpr void emplace_back(Args&&... args) {
+            if (first + count == N) {
+                T temp(std::forward<Args>(args)...);
+                check_back();
+                construct(first + count, std::move(temp));
+            } else {
+                construct(first + count, std::forward<Args>(args)...);
+            }
+            ++count;
+            modified();
+        }
+        
+        constexpr void push_front(const T& that) { emplace_front(that); }
+        constexpr void push_front(T&& that) { emplace_front(std::move(that)); }
+        
+        template <typename... Args>
+        constexpr void emplace_front(Args&&... args) {
+            if (first == 0) {
+                T temp(std::forward<Args>(args)...);
+                check_front();
+                construct(first - 1, std::move(temp));
+            } else {
+                construct(first - 1, std::forward<Args>(args)...);
+            }
+            --first;
+            ++count;
+            modified();
+        }
+        
+        constexpr void pop_back(void) {
+            modified();
+            if (count == 0) { ErrorPolicy::out_of_range("empty vector, nothing to pop back"); }
+            --count;
+            destroy(first + count);
+        }
+        
+        constexpr void pop_front(void) {
+            modified();
+            if (count == 0) { ErrorPolicy::out_of_range("empty vector, nothing to pop front"); }
+            destroy(first);
+            ++first;
+            --count;
+        }
+        
+        /*****************************************************************************************/
+        // Iterators
+        /*****************************************************************************************/
+        template <bool Const>
+        class checked_basic_iterator {
+            using container = typename std::conditional<Const, const static_vector, static_vector>::type;
+            
+            container* obj;
+            
+            size_t version;
+            size_t resize_version;
+            uint64_t index;
+            bool valid;
+        
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = typename std::conditional<Const, const T*, T*>::type;
+            using reference = typename std::conditional<Const, const T&, T&>::type;
+            
+            constexpr checked_basic_iterator(void) : obj(nullptr), version(0), resize_version(0), index(0), valid(true) {}
+            
+            template <bool C = Const, typename = typename std::enable_if<C>::type>
+            constexpr checked_basic_iterator(const checked_basic_iterator<false>& that) :
+            obj(that.obj), version(that.version), resize_version(that.resize_version), index(that.index), valid(that.valid) {}
+            
+            constexpr reference operator*(void) const { validate(this); return obj->data()[index]; }
+            constexpr pointer operator->(void) const { validate(this); return obj->data() + index; }
+            constexpr reference operator[](difference_type k) const { validate(this); return obj->data()[index + k]; }
+            
+            constexpr checked_basic_iterator& operator++(void) { return *this += 1; }
+            constexpr checked_basic_iterator operator++(int) { checked_basic_iterator tmp(*this); *this += 1; return tmp; }
+            constexpr checked_basic_iterator& operator--(void) { return *this -= 1; }
+            constexpr checked_basic_iterator operator--(int) { checked_basic_iterator tmp(*this); *this -= 1; return tmp; }
+            
+            constexpr checked_basic_iterator& operator+=(difference_type k) {
+                validate(this);
+                index += k;
+                valid = (index < obj->size());
+                return *this;
+            }
+            
+            constexpr checked_basic_iterator& operator-=(difference_type k) { return *this += -k; }
+            constexpr checked_basic_iterator operator+(difference_type k) const { checked_basic_iterator tmp(*this); return tmp += k; }
+            constexpr checked_basic_iterator operator-(difference_type k) const { checked_basic_iterator tmp(*this); return tmp -= k; }
+            friend constexpr checked_basic_iterator operator+(difference_type k, const checked_basic_iterator& it) { return it + k; }
+            
+            constexpr difference_type operator-(const checked_basic_iterator& that) const {
+                validate(this);
+                validate(&that);
+                return index - that.index;
+            }
+            
+            constexpr bool operator==(const checked_basic_iterator& that) const {
+                validate(this);
+                validate(&that);
+                return index == that.index;
+            }
+            
+            constexpr bool operator!=(const checked_basic_iterator& that) const { return ! (*this == that); }
+            
+            constexpr bool operator<(const checked_basic_iterator& that) const {
+                validate(this);
+                validate(&that);
+                return index < that.index;
+            }
+            
+            constexpr bool operator>(const checked_basic_iterator& that) const { return that < *this; }
+            constexpr bool operator<=(const checked_basic_iterator& that) const { return ! (that < *this); }
+            constexpr bool operator>=(const checked_basic_iterator& that) const { return ! (*this < that); }
+            
+            friend static_vector;
+            friend class checked_basic_iterator<true>;
+        
+        private:
+            constexpr checked_basic_iterator(container* obj, uint64_t index) :
+            obj(obj), version(obj->version), resize_version(obj->resize_version), index(index), valid(index < obj->size()) {}
+            
+            constexpr void validate(const checked_basic_iterator* iter) const {
+                if ((iter->version != iter->obj->version) || (iter->resize_version != iter->obj->resize_version)) {
+                    invalid_iterator::SeverityLevel level = epl::invalid_iterator::MILD;
+                    if (iter->valid && (iter->index >= iter->obj->size()))
+                    { level = epl::invalid_iterator::SEVERE; }
+                    else if (iter->valid && (iter->resize_version != iter->obj->resize_version))
+                    { level = epl::invalid_iterator::MODERATE; }
+                    throw epl::invalid_iterator{ level };
+                }
+            }
+        };
+        
+        // As for vector, the checked policy gives validating iterators and
+        // the unchecked policy plain pointers into the slots.
+        using iterator = typename std::conditional<Checking::enabled, checked_basic_iterator<false>, T*>::type;
+        using const_iterator = typename std::conditional<Checking::enabled, checked_basic_iterator<true>, const T*>::type;
+        
+        constexpr iterator begin(void) { return make_iterator<iterator>(this, 0, checking_tag{}); }
+        constexpr iterator end(void) { return make_iterator<iterator>(this, count, checking_tag{}); }
+        constexpr const_iterator begin(void) const { return make_iterator<const_iterator>(this, 0, checking_tag{}); }
+        constexpr const_iterator end(void) const { return make_iterator<const_iterator>(this, count, checking_tag{}); }
+        constexpr const_iterator cbegin(void) const { return begin(); }
+        constexpr const_iterator cend(void) const { return end(); }
+    
+    private:
+        using checking_tag = std::integral_constant<bool, Checking::enabled>;
+        
+        template <typename Iterator, typename Self>
+        static constexpr Iterator make_iterator(Self* self, uint64_t index, std::true_type) { return Iterator(self, index); }
+        
+        template <typename Iterator, typename Self>
+        static constexpr Iterator make_iterator(Self* self, uint64_t index, std::false_type) { return self->data() + index; }
+        
+        constexpr void modified(void) { if (Checking::enabled) { ++version; } }
+        constexpr void resized(void) { if (Checking::enabled) { ++resize_version; } }
+        
+        // makes room for one more element at the back by sliding towards
+        // the front, leaving the free slots split between the two ends
+        constexpr void check_back(void) {
+            if (count == N) { ErrorPolicy::overflow("static_vector is full"); }
+            const uint64_t new_first = (N - count) / 2;
+            slide(first, new_first, count);
+            first = new_first;
+            resized();
+        }
+        
+        constexpr void check_front(void) {
+            if (count == N) { ErrorPolicy::overflow("static_vector is full"); }
+            const uint64_t new_first = (N - count + 1) / 2;
+            slide(first, new_first, count);
+            first = new_first;
+            resized();
+        }
+    };
+    
+} //namespace epl
+
+#endif
@@ -1,17 +1,22 @@
 #ifndef _VECTOR_H_
 #define _VECTOR_H_
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
 
-//Utility gives std::rel_ops which will fill in relational
-//iterator operations so long as you provide the
-//operators discussed in class.  In any case, ensure that
-//all operations listed in this website are legal for your
-//iterators:
-//http://www.cplusplus.com/reference/iterator/RandomAccessIterator/
-using namespace std::rel_ops;
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 
 namespace epl{
     
@@ -32,103 +37,405 @@ namespace epl{
         }
     };
     
+    // Instrumentation.  Compiling with EPL_VECTOR_STATS makes every vector
+    // keep these counters for itself and add them to a process-wide total.
+    // Without it the counters are not stored and stats() returns zeros, so
+    // code using the API still compiles but pays nothing.
+    struct vector_stats {
+        uint64_t allocations = 0;           // buffers obtained from the allocator
+        uint64_t back_reallocations = 0;    // growth for push_back / reserve / append
+        uint64_t front_reallocations = 0;   // growth for push_front / reserve_front / prepend
+        uint64_t recenters = 0;             // slides within the buffer instead of growing
+        uint64_t shrinks = 0;               // shrink_to_fit and auto shrink
+        uint64_t elements_relocated = 0;
+        uint64_t bytes_relocated = 0;
+        uint64_t peak_capacity = 0;         // in elements; the largest single buffer for the global total
+        uint64_t severe_faults = 0;         // invalid_iterator thrown, by severity
+        uint64_t moderate_faults = 0;
+        uint64_t mild_faults = 0;
+        double slack_ratio = 0;             // unused share of the buffer, per vector only
+    };
+    
+    namespace detail {
+        struct global_stats {
+            std::atomic<uint64_t> allocations{0};
+            std::atomic<uint64_t> back_reallocations{0};
+            std::atomic<uint64_t> front_reallocations{0};
+            std::atomic<uint64_t> recenters{0};
+            std::atomic<uint64_t> shrinks{0};
+            std::atomic<uint64_t> elements_relocated{0};
+            std::atomic<uint64_t> bytes_relocated{0};
+            std::atomic<uint64_t> peak_capacity{0};
+            std::atomic<uint64_t> severe_faults{0};
+            std::atomic<uint64_t> moderate_faults{0};
+            std::atomic<uint64_t> mild_faults{0};
+        };
+        
+        inline global_stats& stats_totals(void) {
+            static global_stats totals;
+            return totals;
+        }
+    }
+    
+    inline vector_stats global_vector_stats(void) {
+        const detail::global_stats& g = detail::stats_totals();
+        vector_stats s;
+        s.allocations = g.allocations.load(std::memory_order_relaxed);
+        s.back_reallocations = g.back_reallocations.load(std::memory_order_relaxed);
+        s.front_reallocations = g.front_reallocations.load(std::memory_order_relaxed);
+        s.recenters = g.recenters.load(std::memory_order_relaxed);
+        s.shrinks = g.shrinks.load(std::memory_order_relaxed);
+        s.elements_relocated = g.elements_relocated.load(std::memory_order_relaxed);
+        s.bytes_relocated = g.bytes_relocated.load(std::memory_order_relaxed);
+        s.peak_capacity = g.peak_capacity.load(std::memory_order_relaxed);
+        s.severe_faults = g.severe_faults.load(std::memory_order_relaxed);
+        s.moderate_faults = g.moderate_faults.load(std::memory_order_relaxed);
+        s.mild_faults = g.mild_faults.load(std::memory_order_relaxed);
+        return s;
+    }
+    
+    inline void reset_global_vector_stats(void) {
+        detail::global_stats& g = detail::stats_totals();
+        g.allocations = 0;
+        g.back_reallocations = 0;
+        g.front_reallocations = 0;
+        g.recenters = 0;
+        g.shrinks = 0;
+        g.elements_relocated = 0;
+        g.bytes_relocated = 0;
+        g.peak_capacity = 0;
+        g.severe_faults = 0;
+        g.moderate_faults = 0;
+        g.mild_faults = 0;
+    }
+    
+    // Relocation (move-construct into new storage, then destroy the source) is
+    // done with a single memcpy for types where that is known to be equivalent.
+    // Trivially copyable types qualify automatically; other types that do not
+    // care about their own address (no self pointers, no registration with an
+    // observer) may opt in by specializing this trait to std::true_type.
     template <typename T>
-    class vector {
+    struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+    
+    // Checking policies for vector.  Checked iterators remember the version of
+    // the vector they were taken from and throw invalid_iterator when it has
+    // been modified since; unchecked iterators are raw pointers and cost
+    // nothing over a plain array.
+    struct checked { static const bool enabled = true; };
+    struct unchecked { static const bool enabled = false; };
+    
+    // Debug builds check by default and release (NDEBUG) builds do not.  Define
+    // EPL_VECTOR_CHECKED to keep checking in a release build (canaries), or
+    // EPL_VECTOR_UNCHECKED to turn it off in a debug build.
+#if defined(EPL_VECTOR_CHECKED) || (!defined(NDEBUG) && !defined(EPL_VECTOR_UNCHECKED))
+    using default_checking = checked;
+#else
+    using default_checking = unchecked;
+#endif
+    
+    // Growth policies for vector decide how large a new buffer is and how
+    // its free slots are split between the two ends:
+    //   static constexpr uint64_t minimum_capacity
+    //       no heap buffer is smaller than this
+    //   uint64_t grow(uint64_t capacity, uint64_t required, uint64_t element_size) const
+    //       the capacity that replaces a full buffer of `capacity` slots;
+    //       at least `required`
+    //   uint64_t front_room(uint64_t free, uint64_t front_needed, uint64_t back_needed,
+    //                       uint64_t front_left, uint64_t back_left)
+    //       how many of the new buffer's `free` slots go ahead of the
+    //       elements; at least front_needed, and at least back_needed must
+    //       stay behind them.  front_left and back_left are the rooms the
+    //       old buffer had left at each end when it filled up.
+    // The vector holds its policy as an empty base, so a policy may keep
+    // state about the vector it serves without costing the others anything.
+    template <uint64_t Num, uint64_t Den, uint64_t Minimum = 8>
+    struct factor_growth {
+        static constexpr uint64_t minimum_capacity = Minimum;
+        
+        uint64_t grow(uint64_t capacity, uint64_t required, uint64_t) const {
+            uint64_t c = next(capacity);
+            while (c < required) { c = next(c); }
+            return c;
+        }
+        
+        // half of the free slots at each end, or more where more is needed
+        uint64_t front_room(uint64_t free, uint64_t front_needed, uint64_t back_needed, uint64_t, uint64_t) {
+            if (front_needed != 0) { return std::max(front_needed, free / 2); }
+            return free - std::max(back_needed, free / 2);
+        }
+    
     private:
+        static uint64_t next(uint64_t c) {
+            uint64_t n = c * Num / Den;
+            if (n <= c) { n = c + 1; }
+            return n < Minimum ? Minimum : n;
+        }
+    };
+    
+    using double_growth = factor_growth<2, 1>;
+    using one_and_half_growth = factor_growth<3, 2>;
+    
+    // Rounds each new buffer up to the size class malloc hands out for it
+    // anyway, so the slack the allocator would keep becomes capacity.  The
+    // class is found with malloc_usable_size on a probe block allocated and
+    // freed once per growth, which is small next to moving the elements.
+    // Only glibc reports usable sizes; elsewhere this is Base unchanged.
+    //
+    // Every new capacity is at least what Base asks for at that growth, but
+    // since growths start from the rounded capacities the sequence is not
+    // Base's sequence rounded up: the vector may stay below the capacity the
+    // plain policy would have reached by then, and catch up at its next
+    // growth.  The probe describes what malloc does, so the policy is only
+    // accepted for vectors whose buffers come from std::allocator.
+    template <typename Base = double_growth>
+    struct size_class_growth : Base {
+        template <typename Alloc>
+        using supports_allocator = std::is_same<Alloc, std::allocator<typename Alloc::value_type>>;
+        
+        uint64_t grow(uint64_t capacity, uint64_t required, uint64_t element_size) const {
+            uint64_t c = Base::grow(capacity, required, element_size);
+#ifdef __GLIBC__
+            void* probe = std::malloc(c * element_size);
+            if (probe != nullptr) {
+                c = std::max<uint64_t>(c, malloc_usable_size(probe) / element_size);
+                std::free(probe);
+            }
+#endif
+            return c;
+        }
+    };
+    
+    // Splits the free slots of each new buffer in proportion to how much of
+    // each end's room was used since the previous growth, averaged over
+    // growths.  A vector that is only appended to soon keeps next to nothing
+    // at the front; one used as a deque keeps room at both ends.
+    template <typename Base = double_growth>
+    class adaptive_split : public Base {
+        uint64_t front_given = 0;
+        uint64_t back_given = 0;
+        uint64_t front_share = 128; // out of 256
+    
+    public:
+        uint64_t front_room(uint64_t free, uint64_t front_needed, uint64_t back_needed, uint64_t front_left, uint64_t back_left) {
+            uint64_t front_used = front_given > front_left ? front_given - front_left : 0;
+            uint64_t back_used = back_given > back_left ? back_given - back_left : 0;
+            if (front_used + back_used != 0) {
+                front_share = (front_share + 256 * front_used / (front_used + back_used)) / 2;
+            }
+            uint64_t front = free / 256 * front_share + free % 256 * front_share / 256;
+            if (front < front_needed) { front = front_needed; }
+            if (front > free - back_needed) { front = free - back_needed; }
+            front_given = front;
+            back_given = free - front;
+            return front;
+        }
+    };
+    
+    namespace detail {
+        // a growth policy that depends on where buffers come from says which
+        // allocators it works with; the others work with any
+        template <typename Growth, typename Alloc, typename = void>
+        struct growth_supports_allocator : std::true_type {};
+        
+        template <typename Growth, typename Alloc>
+        struct growth_supports_allocator<Growth, Alloc, typename std::enable_if<(sizeof(typename Growth::template supports_allocator<Alloc>) > 0)>::type> :
+        Growth::template supports_allocator<Alloc> {};
+        
+        // raw storage for the first N elements of a small vector; empty when
+        // N is zero so that plain vectors pay nothing for it
+        template <typename T, std::size_t N>
+        class inline_buffer {
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type slots[N];
+        protected:
+            T* inline_data(void) { return reinterpret_cast<T*>(slots); }
+            const T* inline_data(void) const { return reinterpret_cast<const T*>(slots); }
+        };
+        
+        template <typename T>
+        class inline_buffer<T, 0> {
+        protected:
+            T* inline_data(void) { return nullptr; }
+            const T* inline_data(void) const { return nullptr; }
+        };
+        
+        template <typename...>
+        struct voider { typedef void type; };
+        
+        // Optional allocator extensions used by vector when present:
+        //   T* reallocate(T* p, size_t old_n, size_t new_n)
+        //       resizes the block in place or by remapping, preserving its
+        //       bytes; returns nullptr when that is not possible
+        //   void discard(T* p, size_t n)
+        //       lets the system reclaim the memory of unused slots
+        template <typename Alloc, typename = void>
+        struct has_reallocate : std::false_type {};
+        
+        template <typename Alloc>
+        struct has_reallocate<Alloc, typename voider<decltype(std::declval<Alloc&>().reallocate(
+            std::declval<typename Alloc::value_type*>(), size_t(), size_t()))>::type> : std::true_type {};
+        
+        template <typename Alloc, typename = void>
+        struct has_discard : std::false_type {};
+        
+        template <typename Alloc>
+        struct has_discard<Alloc, typename voider<decltype(std::declval<Alloc&>().discard(
+            std::declval<typename Alloc::value_type*>(), size_t()))>::type> : std::true_type {};
+        
+        // owners of a buffer shared by copy-on-write vectors
+        struct owner_count {
+            std::atomic<uint64_t> count{1};
+        };
+        
+        // Iterators over a single array: raw pointers, and class iterators
+        // that say so with a contiguous_iterator typedef (vector's checked
+        // iterators).  Having operator-> is not enough: deque and
+        // chunked_vector iterators have one too.
+        template <typename Iterator, typename = void>
+        struct is_contiguous_iterator : std::is_pointer<Iterator> {};
+        
+        template <typename Iterator>
+        struct is_contiguous_iterator<Iterator, typename voider<typename Iterator::contiguous_iterator>::type> : std::true_type {};
+        
+        // The element pointer behind a contiguous iterator.  A checked
+        // iterator is validated once here, so algorithms that take their
+        // range this way check at the boundary and loop on the pointer.
+        template <typename T>
+        T* to_address(T* p) { return p; }
+        
+        template <typename Iterator, typename = typename std::enable_if<is_contiguous_iterator<Iterator>::value>::type>
+        auto to_address(const Iterator& it) -> decltype(it.operator->()) { return it.operator->(); }
+    }
+    
+    // InlineCapacity > 0 makes a small vector: up to that many elements are
+    // kept inside the object and the heap is only used once they overflow.
+    template <typename T, typename Checking = default_checking, typename Alloc = std::allocator<T>, std::size_t InlineCapacity = 0,
+              typename Growth = double_growth>
+    class vector : private detail::inline_buffer<T, InlineCapacity>, private Growth {
+        static_assert(detail::growth_supports_allocator<Growth, Alloc>::value, "growth policy does not support this allocator");
+        
+    private:
+        using alloc_traits = std::allocator_traits<Alloc>;
+        
+        Alloc alloc;
         
         T* cap_start;
         T* cap_finish;
         T* data_start;
         T* data_end;
         
-        size_t version = 0;
-        size_t resize_version = 0;
+        // Checked iterators compare their stamp against epoch.  Every change to
+        // the elements or the buffer advances it; resize_epoch is its value
+        // after the last change of buffer and only matters once an iterator
+        // has been found stale, to say how stale (see checked_const_iterator).
+        uint64_t epoch = 0;
+        uint64_t resize_epoch = 0;
+        
+        bool auto_shrink = false;
         
-        const uint64_t minimum_capacity = 8;
+        // copy-on-write: non-null once enabled; unshareable is set when a
+        // mutable reference has been handed out, so that copies cannot share
+        // a buffer someone may still write to behind their back
+        detail::owner_count* owners = nullptr;
+        bool unshareable = false;
+
+#ifdef EPL_VECTOR_STATS
+        mutable vector_stats counters;
+#endif
     public:
-        //        using value_type=T;
+        using value_type = T;
+        using reference = T&;
+        using const_reference = const T&;
+        using size_type = uint64_t;
+        using difference_type = std::ptrdiff_t;
+        using allocator_type = Alloc;
         
-        vector(void) {
-            uint64_t capacity = minimum_capacity;
-            cap_start = static_cast<T*>(operator new(capacity * sizeof(T)));
-            cap_finish = cap_start + capacity;
-            data_start = data_end = cap_start;
+        vector(void) : vector(Alloc()) {
         }
         
-        explicit vector(uint64_t n) {
-            uint64_t capacity = n;
-            if (n == 0) { capacity = minimum_capacity; }
-            cap_start = static_cast<T*>(operator new(capacity * sizeof(T)));
-            cap_finish = cap_start + capacity;
-            data_start = data_end = cap_start;
+        explicit vector(const Alloc& alloc) : alloc(alloc) {
+            init_storage(0);
+            if (is_inline()) { data_start = data_end = cap_start + InlineCapacity / 2; }
+        }
+        
+        explicit vector(uint64_t n, const Alloc& alloc = Alloc()) : alloc(alloc) {
+            init_storage(n);
             for (uint64_t k = 0; k < n; k += 1) {
-                new (data_end) T();
+                alloc_traits::construct(this->alloc, data_end);
                 ++data_end;
             }
             
         }
         
-        vector(const vector<T>& that) {
+        vector(const vector& that) : alloc(alloc_traits::select_on_container_copy_construction(that.alloc)) {
             copy(that);
             
         }
         
-        vector(vector<T>&& that) {
+        vector(vector&& that) noexcept(InlineCapacity == 0 || nothrow_relocatable::value) : alloc(std::move(that.alloc)) {
             move(std::move(that));
             
         }
         
-        template <typename AltType>
-        vector(const vector<AltType>& that) {
-            uint64_t capacity = that.size();
-            if (capacity == 0) { capacity = minimum_capacity; }
-            cap_start = static_cast<T*>(operator new(capacity * sizeof(T)));
-            cap_finish = cap_start + capacity;
-            data_start = data_end = cap_start;
-            for (uint64_t k = 0; k < capacity; k += 1) {
-                new (data_end) T(that[k]);
+        template <typename AltType, typename AltChecking, typename AltAlloc, std::size_t AltInline, typename AltGrowth>
+        vector(const vector<AltType, AltChecking, AltAlloc, AltInline, AltGrowth>& that, const Alloc& alloc = Alloc()) : alloc(alloc) {
+            init_storage(that.size());
+            for (uint64_t k = 0; k < that.size(); k += 1) {
+                alloc_traits::construct(this->alloc, data_end, that[k]);
                 ++data_end;
             }
             
         }
         
         template <typename Iterator>
-        vector(Iterator start, Iterator finish) {
+        vector(Iterator start, Iterator finish, const Alloc& alloc = Alloc()) : alloc(alloc) {
             constructFromIterator(start, finish, typename std::iterator_traits<Iterator>::iterator_category());
             
         }
         
-        vector(std::initializer_list<T> il) :
-        vector(il.begin(), il.end()) {
+        vector(std::initializer_list<T> il, const Alloc& alloc = Alloc()) :
+        vector(il.begin(), il.end(), alloc) {
         }
         
         ~vector(void) {
             destroy();
         }
         
-        vector<T>& operator=(const vector<T>& rhs) {
+        vector& operator=(const vector& rhs) {
             if (this != &rhs) {
                 destroy();
+                make_empty(); // so that a throwing copy leaves an empty vector, not a dangling one
+                if (alloc_traits::propagate_on_container_copy_assignment::value) { alloc = rhs.alloc; }
                 copy(rhs);
-                ++resize_version;
-                ++version;
+                resized();
+                modified();
             }
             return *this;
         }
         
-        vector<T>& operator=(vector<T>&& rhs) {
+        vector& operator=(vector&& rhs) noexcept((InlineCapacity == 0 || nothrow_relocatable::value) &&
+                                                 (alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value)) {
+            if (this == &rhs) { return *this; }
             destroy();
-            move(std::move(rhs));
-            ++version;
-            ++resize_version;
+            make_empty(); // as in copy assignment
+            move_assign(std::move(rhs), typename alloc_traits::propagate_on_container_move_assignment{});
+            modified();
+            resized();
             return *this;
         }
         
+        Alloc get_allocator(void) const {
+            return alloc;
+        }
+        
         uint64_t size(void) const {
             return data_end - data_start;
         }
         
+        T* data(void) { expose(); return data_start; }
+        const T* data(void) const { return data_start; }
+        
         T& operator[](uint64_t k) {
+            expose();
             T* p = data_start + k;
             if (p >= data_end) { throw std::out_of_range("index out of range"); }
             return *p;
@@ -140,71 +447,96 @@ namespace epl{
             return *p;
         }
         
+        // The new element is built directly in its slot.  An argument that
+        // is an element of this vector is found again by its index once the
+        // room has been made, since making room may move it.
         void push_back(const T& that) {
-            T temp(that);
+            uint64_t alias = index_of(std::addressof(that));
+            unshare();
             check_back(1);
-            new (data_end) T(std::move(temp));
+            alloc_traits::construct(alloc, data_end, alias == size() ? that : data_start[alias]);
             ++data_end;
-            ++version;
-            
+            modified();
         }
         
         void push_back(T&& that) {
-            T temp(std::move(that));
+            uint64_t alias = index_of(std::addressof(that));
+            unshare();
             check_back(1);
-            new (data_end) T(std::move(temp));
-            //            new (data_end) T(std::move(that));
+            alloc_traits::construct(alloc, data_end, std::move(alias == size() ? that : data_start[alias]));
             ++data_end;
-            ++version;
+            modified();
         }
         
+        // the arguments may refer to elements in any way, so they are only
+        // built in place when no element is going to move
         template <typename... Args>
         void emplace_back(Args&&... args) {
-            check_back(1);
-            new(data_end) T(std::forward<Args>(args)...);
-            ++version;
+            if (data_end == cap_finish || is_shared()) {
+                T temp(std::forward<Args>(args)...);
+                unshare();
+                check_back(1);
+                alloc_traits::construct(alloc, data_end, std::move(temp));
+            } else {
+                alloc_traits::construct(alloc, data_end, std::forward<Args>(args)...);
+            }
+            ++data_end;
+            modified();
         }
         
         void push_front(const T& that) {
-            T temp(that);
+            uint64_t alias = index_of(std::addressof(that));
+            unshare();
             check_front(1);
+            alloc_traits::construct(alloc, data_start - 1, alias == size() ? that : data_start[alias]);
             --data_start;
-            new (data_start) T(std::move(temp));
-            ++version;
+            modified();
         }
         
         void push_front(T&& that) {
-            T temp(std::move(that));
+            uint64_t alias = index_of(std::addressof(that));
+            unshare();
             check_front(1);
+            alloc_traits::construct(alloc, data_start - 1, std::move(alias == size() ? that : data_start[alias]));
             --data_start;
-            new (data_start) T(std::move(temp));
-            ++version;
+            modified();
         }
         
         template <typename... Args>
         void emplace_front(Args&&... args) {
-            check_front(1);
+            if (data_start == cap_start || is_shared()) {
+                T temp(std::forward<Args>(args)...);
+                unshare();
+                check_front(1);
+                alloc_traits::construct(alloc, data_start - 1, std::move(temp));
+            } else {
+                alloc_traits::construct(alloc, data_start - 1, std::forward<Args>(args)...);
+            }
             --data_start;
-            new (data_start) T(std::forward<Args>(args)...);
-            ++version;
+            modified();
         }
         
         void pop_back(void) {
-            ++version;
+            modified();
             if (data_start == data_end) { throw std::out_of_range("empty vector, nothing to pop back"); }
+            unshare();
             --data_end;
-            data_end->~T();
+            alloc_traits::destroy(alloc, data_end);
+            if (auto_shrink) { check_shrink(); }
         }
         
         void pop_front(void) {
-            ++version;
+            modified();
             if (data_start == data_end) { throw std::out_of_range("empty vector, nothing to pop front"); }
-            data_start->~T();
+            unshare();
+            alloc_traits::destroy(alloc, data_start);
             ++data_start;
+            if (auto_shrink) { check_shrink(); }
         }
         
         T& front(void) {
             if (data_start == data_end) { throw std::out_of_range("empty Vector"); }
+            expose();
             return *data_start;
         }
         
@@ -215,6 +547,7 @@ namespace epl{
         
         T& back(void) {
             if (data_start == data_end) { throw std::out_of_range("back called on empty Vector"); }
+            expose();
             return *(data_end - 1);
         }
         
@@ -223,277 +556,990 @@ namespace epl{
             return *(data_end - 1);
         }
         
-        class iterator;
-        class const_iterator : public std::iterator<std::random_access_iterator_tag, T> {
-            const vector<T>* obj;
-            
-            uint64_t version;
-            uint64_t resize_version;
-            uint64_t index; // change from pointer to index for the convinience of comparison
-            bool valid;
+        class checked_iterator;
+        
+        // The vector, the index and a stamp holding the epoch the iterator
+        // was made in (upper 63 bits) and whether it referred to an element
+        // when last moved (low bit).  Validating is a single compare of the
+        // stamp with the vector's epoch.  Stepping rewrites the stamp from the
+        // epoch it has just validated, so only the index is carried from one
+        // step to the next and a loop over the iterator keeps the checks off
+        // its critical path.  Only a stale iterator goes on to work out how
+        // stale it is.  Index and epoch are 64 bits wide, so any vector can
+        // be iterated and the epoch does not wrap in practice.
+        class checked_const_iterator {
+            const vector* obj;
+            uint64_t index;
+            uint64_t stamp;
+        
+        public:
+            static const uint64_t epoch_unit = 2;
             
-            //        using Same = const_iterator;
+            using iterator_category = std::random_access_iterator_tag;
+#if __cplusplus >= 202002L
+            using iterator_concept = std::contiguous_iterator_tag;
+#endif
+            using contiguous_iterator = std::true_type;
+            using value_type = T;
+            using element_type = const T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const T*;
+            using reference = const T&;
             
-        public:
-            const_iterator(void) { // no use
-                obj = nullptr;
-                version = 0;
-                resize_version = 0;
-                index = 0;
-                valid = true;
-            }
-            
-            const_iterator(const vector<T>* obj, size_t version, size_t resize_version, uint64_t index) {
-                this->obj = obj;
-                this->version = version;
-                this->resize_version = resize_version;
-                this->index = index;
-                this->valid = (index >=0 && index < obj->size());
-            }
-            
-            const_iterator(const const_iterator& that) : obj(that.obj), version(that.version), resize_version(that.resize_version), index(that.index), valid(that.valid) {};
-            
-            const_iterator operator=(const const_iterator& that) {
-                obj = that.obj;
-                version = that.version;
-                resize_version = that.resize_version;
-                index = that.index;
-                valid = that.valid;
-                return *this;
+            checked_const_iterator(void) : obj(nullptr), index(0), stamp(1) { // no use
             }
             
-            
+            checked_const_iterator(const vector* obj, uint64_t epoch, uint64_t index) :
+            obj(obj), index(index), stamp(epoch | (index < obj->size())) {
+            }
             
             const T& operator*(void) const {
-                validate(this);
+                validate();
                 return *(obj->data_start + index);
             }
             
-            const_iterator& operator++(void) {
-                validate(this);
-                ++index;
-                valid = (index >= 0 && index < obj->size());
-                return *this;
+            const T* operator->(void) const {
+                validate();
+                return obj->data_start + index;
+            }
+            
+            const T& operator[](difference_type k) const {
+                validate();
+                return *(obj->data_start + index + k);
+            }
+            
+            checked_const_iterator& operator++(void) {
+                return *this += 1;
             }
             
-            const_iterator operator++(int) {
-                const_iterator tmp(*this);
+            checked_const_iterator operator++(int) {
+                checked_const_iterator tmp(*this);
                 this->operator++();
                 return tmp;
             }
             
-            const_iterator& operator--(void) {
-                validate(this);
-                --index;
-                valid = (index >= 0 && index < obj->size());
-                return *this;
+            checked_const_iterator& operator--(void) {
+                return *this -= 1;
             }
             
-            
-            const_iterator operator--(int) {
-                const_iterator tmp(*this);
+            checked_const_iterator operator--(int) {
+                checked_const_iterator tmp(*this);
                 this->operator--();
                 return tmp;
             }
             
-            int64_t operator-(const const_iterator& that) const {
-                validate(this);
-                validate(&that);
-                return this->index - that.index;
+            checked_const_iterator& operator+=(difference_type k) {
+                validate();
+                index += static_cast<uint64_t>(k); // a negative index wraps and is never valid
+                stamp = obj->epoch | (index < obj->size());
+                return *this;
             }
             
-            const_iterator operator+(int64_t k) {
-                validate(this);
-                index += k;
-                valid = (index >= 0 && index < obj->size());
-                return *this;
+            checked_const_iterator& operator-=(difference_type k) {
+                return *this += -k;
             }
             
+            checked_const_iterator operator+(difference_type k) const {
+                checked_const_iterator tmp(*this);
+                return tmp += k;
+            }
             
-            T& operator[](uint64_t k) { return *(obj->data_start + index + k); }
+            friend checked_const_iterator operator+(difference_type k, const checked_const_iterator& it) {
+                return it + k;
+            }
             
+            checked_const_iterator operator-(difference_type k) const {
+                checked_const_iterator tmp(*this);
+                return tmp -= k;
+            }
             
+            difference_type operator-(const checked_const_iterator& that) const {
+                validate_pair(that);
+                return difference_type(this->index) - difference_type(that.index);
+            }
             
-            bool operator==(const const_iterator& that) const {
-                validate(this);
-                validate(&that);
+            bool operator==(const checked_const_iterator& that) const {
+                validate_pair(that);
                 return this->index == that.index;
             }
             
-            bool operator!=(const const_iterator& that) const {
+            bool operator!=(const checked_const_iterator& that) const {
                 return ! (*this == that);
             }
             
-            friend vector<T>;
-            friend vector<T>::iterator;
+            bool operator<(const checked_const_iterator& that) const {
+                validate_pair(that);
+                return this->index < that.index;
+            }
             
-            void validate(const const_iterator* iter) const {
-                if ((iter->version != iter->obj->version) || (iter->resize_version != iter->obj->resize_version)) {
-                    if (iter->valid && (iter->index < 0 || iter->index >= iter->obj->size()))
-                    {throw epl::invalid_iterator{ epl::invalid_iterator::SEVERE };}
-                    else if (iter->valid && (iter->resize_version != iter->obj->resize_version))
-                    {throw epl::invalid_iterator{ epl::invalid_iterator::MODERATE };}
-                    else
-                    { throw epl::invalid_iterator{ epl::invalid_iterator::MILD }; }
-                }
+            bool operator>(const checked_const_iterator& that) const { return that < *this; }
+            bool operator<=(const checked_const_iterator& that) const { return ! (that < *this); }
+            bool operator>=(const checked_const_iterator& that) const { return ! (*this < that); }
+            
+            friend vector;
+            friend vector::checked_iterator;
+        
+        private:
+            void validate(void) const {
+                if ((stamp ^ obj->epoch) >= epoch_unit) { stale(obj, index, stamp); }
             }
             
+            // Two iterators of one vector made in the same epoch, such as the
+            // two ends of a range-for, are both checked by checking one.
+            void validate_pair(const checked_const_iterator& that) const {
+                validate();
+                if ((that.obj != obj) || ((stamp ^ that.stamp) >= epoch_unit)) { that.validate(); }
+            }
             
+            // The iterator is SEVERE if it referred to an element that is now
+            // past the end, MODERATE if the buffer has changed since it was
+            // made, and MILD otherwise.  Epochs are compared by how far they
+            // are behind the current one.  The fields are passed by value so that the iterator's address never escapes
+            // and the compiler can keep it in registers.
+            [[noreturn]] static void stale(const vector* obj, uint64_t index, uint64_t stamp) {
+                const uint64_t age = obj->epoch - (stamp & ~uint64_t(1));
+                const uint64_t since_resize = obj->epoch - obj->resize_epoch;
+                const bool valid = (stamp & 1) != 0;
+                invalid_iterator::SeverityLevel level;
+                if (valid && (index >= obj->size()))
+                { level = epl::invalid_iterator::SEVERE; }
+                else if (valid && since_resize < age)
+                { level = epl::invalid_iterator::MODERATE; }
+                else
+                { level = epl::invalid_iterator::MILD; }
+                obj->count_fault(level);
+                throw epl::invalid_iterator{ level };
+            }
         };
         
-        class iterator : public const_iterator {
-            
+        class checked_iterator : public checked_const_iterator {
+            using base = checked_const_iterator;
+        
         public:
-            iterator(void) {}
+            using element_type = T;
+            using pointer = T*;
+            using reference = T&;
+            using typename base::difference_type;
             
-            T& operator*(void) const {
-                return const_cast<T&>(const_iterator::operator*());
-            }
+            checked_iterator(void) {}
             
-            iterator operator+(int64_t k) {
-                const_iterator::operator+(k); //calls checkRevision for us
-                return iterator(const_iterator::obj, const_iterator::version, const_iterator::resize_version, const_iterator::index);
-            }
-            iterator& operator++(void) { const_iterator::operator++(); return *this; }
-            iterator operator++(int) { iterator tmp(*this); operator++(); return tmp; }
-            iterator& operator--(void) { const_iterator::operator--(); return *this; }
-            iterator operator--(int) { iterator tmp(*this); operator--(); return tmp; }
+            T& operator*(void) const { return const_cast<T&>(base::operator*()); }
+            T* operator->(void) const { return const_cast<T*>(base::operator->()); }
+            T& operator[](difference_type k) const { return const_cast<T&>(base::operator[](k)); }
+            
+            checked_iterator& operator++(void) { base::operator++(); return *this; }
+            checked_iterator operator++(int) { checked_iterator tmp(*this); operator++(); return tmp; }
+            checked_iterator& operator--(void) { base::operator--(); return *this; }
+            checked_iterator operator--(int) { checked_iterator tmp(*this); operator--(); return tmp; }
+            
+            checked_iterator& operator+=(difference_type k) { base::operator+=(k); return *this; }
+            checked_iterator& operator-=(difference_type k) { base::operator-=(k); return *this; }
+            checked_iterator operator+(difference_type k) const { checked_iterator tmp(*this); return tmp += k; }
+            checked_iterator operator-(difference_type k) const { checked_iterator tmp(*this); return tmp -= k; }
+            friend checked_iterator operator+(difference_type k, const checked_iterator& it) { return it + k; }
+            using base::operator-;
+        
         private:
-            friend vector<T>;
-            iterator(const vector<T>* obj, size_t version, size_t resize_version, uint64_t index) : const_iterator(obj, version, resize_version, index) { }
+            friend vector;
+            checked_iterator(const vector* obj, uint64_t epoch, uint64_t index) : base(obj, epoch, index) { }
         };
         
-        const_iterator begin(void) const { return const_iterator(this, version, resize_version, 0); }
-        iterator begin(void) { return iterator(this, version, resize_version, 0); }
+        // With the checked policy iterators are the validating classes above;
+        // with the unchecked policy they are plain pointers into the buffer.
+        using iterator = typename std::conditional<Checking::enabled, checked_iterator, T*>::type;
+        using const_iterator = typename std::conditional<Checking::enabled, checked_const_iterator, const T*>::type;
+        
+        const_iterator begin(void) const { return make_iterator<const_iterator>(0, checking_tag{}); }
+        iterator begin(void) { expose(); return make_iterator<iterator>(0, checking_tag{}); }
+        
+        const_iterator end(void) const { return make_iterator<const_iterator>(size(), checking_tag{}); }
+        iterator end(void) { expose(); return make_iterator<iterator>(size(), checking_tag{}); }
+        
+        uint64_t capacity(void) const {
+            return cap_finish - cap_start;
+        }
+        
+        // makes room for n elements starting at the current front, so that
+        // push_back can run until size() == n without reallocating
+        void reserve(uint64_t n) {
+            uint64_t front_room = data_start - cap_start;
+            if (n <= (uint64_t) (cap_finish - data_start)) { return; }
+            unshare();
+            count(&vector_stats::back_reallocations, &detail::global_stats::back_reallocations);
+            reallocate(front_room + n, front_room);
+        }
+        
+        // makes room for n elements ending at the current back, so that
+        // push_front can run until size() == n without reallocating
+        void reserve_front(uint64_t n) {
+            uint64_t back_room = cap_finish - data_end;
+            if (n <= (uint64_t) (data_end - cap_start)) { return; }
+            unshare();
+            count(&vector_stats::front_reallocations, &detail::global_stats::front_reallocations);
+            reallocate(n + back_room, n - size());
+        }
+        
+        void resize(uint64_t n) {
+            unshare();
+            if (n > size()) {
+                check_back(n - size());
+                T* new_end = data_start + n;
+                T* p = data_end;
+                try {
+                    for (; p != new_end; ++p) { alloc_traits::construct(alloc, p); }
+                } catch (...) {
+                    destroy_range(data_end, p);
+                    throw;
+                }
+                data_end = new_end;
+            } else {
+                T* new_end = data_start + n;
+                destroy_range(new_end, data_end);
+                data_end = new_end;
+            }
+            modified();
+        }
+        
+        template <typename Iterator>
+        void assign(Iterator first, Iterator last) {
+            unshare();
+            assign(first, last, typename std::iterator_traits<Iterator>::iterator_category());
+        }
+        
+        template <typename Iterator>
+        void append(Iterator first, Iterator last) {
+            unshare();
+            append(first, last, typename std::iterator_traits<Iterator>::iterator_category());
+        }
         
-        const_iterator end(void) const { return const_iterator(this, version, resize_version, size()); }
-        iterator end(void) { return iterator(this, version, resize_version, size()); }
+        template <typename Iterator>
+        void prepend(Iterator first, Iterator last) {
+            unshare();
+            prepend(first, last, typename std::iterator_traits<Iterator>::iterator_category());
+        }
+        
+        // inserts [first, last) before pos; the elements are added at
+        // whichever end is closer to pos and rotated into place, so only the
+        // shorter side of the vector moves.  As with assign, append and
+        // prepend, the range must not point into this vector.
+        template <typename Iterator>
+        iterator insert(const_iterator pos, Iterator first, Iterator last) {
+            uint64_t index = pos - cbegin();
+            uint64_t old_size = size();
+            if (index < old_size / 2) {
+                prepend(first, last);
+                uint64_t n = size() - old_size;
+                std::rotate(data_start, data_start + n, data_start + n + index);
+            } else {
+                append(first, last);
+                std::rotate(data_start + index, data_start + old_size, data_end);
+            }
+            expose();
+            return make_iterator<iterator>(index, checking_tag{});
+        }
+        
+        // removes [first, last); like insert, the gap is closed from
+        // whichever end is closer, so only the shorter side moves
+        iterator erase(const_iterator first, const_iterator last) {
+            uint64_t index = first - cbegin();
+            uint64_t n = last - first;
+            unshare();
+            if (index < size() - index - n) {
+                std::move_backward(data_start, data_start + index, data_start + index + n);
+                destroy_range(data_start, data_start + n);
+                data_start += n;
+            } else {
+                std::move(data_start + index + n, data_end, data_start + index);
+                destroy_range(data_end - n, data_end);
+                data_end -= n;
+            }
+            modified();
+            if (auto_shrink) { check_shrink(); }
+            expose();
+            return make_iterator<iterator>(index, checking_tag{});
+        }
+        
+        iterator erase(const_iterator pos) {
+            return erase(pos, pos + 1);
+        }
+        
+        // gives back unused capacity; a small vector whose elements fit
+        // inline moves them back into the object
+        void shrink_to_fit(void) {
+            unshare();
+            uint64_t n = size();
+            if (InlineCapacity != 0 && n <= InlineCapacity) {
+                if (is_inline()) { return; }
+                T* old_start = cap_start;
+                uint64_t old_capacity = cap_finish - cap_start;
+                T* new_data = this->inline_data() + (InlineCapacity - n) / 2;
+                data_end = transfer(data_start, data_end, new_data, nothrow_relocatable{});
+                data_start = new_data;
+                cap_start = this->inline_data();
+                cap_finish = cap_start + InlineCapacity;
+                deallocate(old_start, old_capacity);
+                count(&vector_stats::shrinks, &detail::global_stats::shrinks);
+                count_relocation(n);
+                resized();
+                return;
+            }
+            if (n < Growth::minimum_capacity) { n = Growth::minimum_capacity; }
+            if (n < (uint64_t) (cap_finish - cap_start)) {
+                count(&vector_stats::shrinks, &detail::global_stats::shrinks);
+                reallocate(n, (n - size()) / 2);
+            }
+        }
         
+        // returns the memory behind unused slots at both ends to the system
+        // while keeping the capacity, for allocators that support it (see
+        // detail::has_discard); a no-op otherwise
+        void release_slack(void) {
+            discard_slack(detail::has_discard<Alloc>{});
+        }
+        
+        // counters for this vector (all zero unless built with EPL_VECTOR_STATS)
+        vector_stats stats(void) const {
+            vector_stats s;
+#ifdef EPL_VECTOR_STATS
+            s = counters;
+#endif
+            uint64_t capacity = cap_finish - cap_start;
+            if (capacity != 0) { s.slack_ratio = 1.0 - (double) size() / (double) capacity; }
+            return s;
+        }
+        
+        void reset_stats(void) {
+#ifdef EPL_VECTOR_STATS
+            counters = vector_stats();
+#endif
+        }
+        
+        // With auto shrink on, pop_front/pop_back halve the buffer once it
+        // falls below a quarter full.  The gap between the two thresholds
+        // keeps a vector hovering around one size from reallocating on
+        // every push/pop.
+        void set_auto_shrink(bool enabled) {
+            auto_shrink = enabled;
+        }
+        
+        // With copy-on-write on, copies share this vector's buffer (and turn
+        // copy-on-write on for themselves) until one of them is modified:
+        // every push, pop, resize and non-const access (operator[], front,
+        // back, data, begin, end) first gives that vector a private copy of
+        // the elements.  Reading a shared vector through a const reference
+        // never copies.  Iterators taken before the copy is made are
+        // invalidated as by a reallocation.  A vector that has handed out a
+        // mutable reference is copied in full until its buffer next moves,
+        // since the reference could otherwise write into a shared buffer.
+        // The owner count is atomic, so copies may live in different threads.
+        void set_copy_on_write(bool enabled) {
+            if (enabled && owners == nullptr) {
+                owners = new detail::owner_count();
+            } else if (!enabled && owners != nullptr) {
+                unshare();
+                delete owners;
+                owners = nullptr;
+            }
+        }
+        
+        // true while other copies share this vector's buffer
+        bool is_shared(void) const {
+            return owners != nullptr && owners->count.load(std::memory_order_acquire) != 1;
+        }
+        
+        const_iterator cbegin(void) const { return begin(); }
+        const_iterator cend(void) const { return end(); }
+    
     private:
+        using checking_tag = std::integral_constant<bool, Checking::enabled>;
+        
+        template <typename Iterator>
+        Iterator make_iterator(uint64_t index, std::true_type) const {
+            return Iterator(this, epoch, index);
+        }
+        
+        template <typename Iterator>
+        Iterator make_iterator(uint64_t index, std::false_type) const { return Iterator(data_start + index); }
+        
+        // the epochs are only read by checked iterators, so unchecked
+        // vectors do not pay for maintaining them
+        void modified(void) { if (Checking::enabled) { epoch += checked_const_iterator::epoch_unit; } }
+        
+        void resized(void) {
+            if (Checking::enabled) {
+                epoch += checked_const_iterator::epoch_unit;
+                resize_epoch = epoch;
+            }
+            unshareable = false;
+        }
+        
+        // the position of the element at p, or size() if p is not one of ours
+        uint64_t index_of(const T* p) const {
+            std::less<const T*> before;
+            if (before(p, data_start) || !before(p, data_end)) { return size(); }
+            return p - data_start;
+        }
+        
+        // called before the elements or the buffer are changed
+        void unshare(void) {
+            if (owners != nullptr && owners->count.load(std::memory_order_acquire) != 1) { detach(); }
+        }
+        
+        // called before a mutable reference, pointer or iterator is returned
+        void expose(void) {
+            if (owners == nullptr) { return; }
+            unshare();
+            unshareable = true;
+        }
+        
+        bool shareable(void) const {
+            return owners != nullptr && !unshareable && cap_start != nullptr && !is_inline();
+        }
+        
+        // copies the shared elements into a private buffer with the same
+        // capacity and front room; the vector is unchanged if that throws
+        void detach(void) {
+            detail::owner_count* fresh = new detail::owner_count();
+            uint64_t capacity = cap_finish - cap_start;
+            T* new_address = nullptr;
+            T* new_data = nullptr;
+            T* new_data_end = nullptr;
+            try {
+                new_address = allocate(capacity);
+                new_data = new_address + (data_start - cap_start);
+                new_data_end = construct_range(new_data, const_cast<const T*>(data_start), const_cast<const T*>(data_end));
+            } catch (...) {
+                if (new_address != nullptr) { deallocate(new_address, capacity); }
+                delete fresh;
+                throw;
+            }
+            destroy(); // the last other owner may have let go in the meantime
+            owners = fresh;
+            cap_start = new_address;
+            cap_finish = cap_start + capacity;
+            data_start = new_data;
+            data_end = new_data_end;
+            resized();
+            modified();
+        }
+        
+        T* allocate(uint64_t capacity) {
+            T* p = alloc_traits::allocate(alloc, capacity);
+            count_allocation(capacity);
+            return p;
+        }
+        
+        // instrumentation hooks, empty unless EPL_VECTOR_STATS is defined
+        void count_allocation(uint64_t capacity) {
+#ifdef EPL_VECTOR_STATS
+            ++counters.allocations;
+            if (capacity > counters.peak_capacity) { counters.peak_capacity = capacity; }
+            detail::global_stats& g = detail::stats_totals();
+            g.allocations.fetch_add(1, std::memory_order_relaxed);
+            uint64_t peak = g.peak_capacity.load(std::memory_order_relaxed);
+            while (capacity > peak && !g.peak_capacity.compare_exchange_weak(peak, capacity, std::memory_order_relaxed)) {}
+#else
+            (void) capacity;
+#endif
+        }
+        
+        void count(uint64_t vector_stats::* field, std::atomic<uint64_t> detail::global_stats::* total, uint64_t n = 1) {
+#ifdef EPL_VECTOR_STATS
+            counters.*field += n;
+            (detail::stats_totals().*total).fetch_add(n, std::memory_order_relaxed);
+#else
+            (void) field; (void) total; (void) n;
+#endif
+        }
+        
+        void count_relocation(uint64_t n) {
+            count(&vector_stats::elements_relocated, &detail::global_stats::elements_relocated, n);
+            count(&vector_stats::bytes_relocated, &detail::global_stats::bytes_relocated, n * sizeof(T));
+        }
+        
+        void count_fault(invalid_iterator::SeverityLevel level) const {
+#ifdef EPL_VECTOR_STATS
+            detail::global_stats& g = detail::stats_totals();
+            switch (level) {
+                case invalid_iterator::SEVERE:   ++counters.severe_faults; g.severe_faults.fetch_add(1, std::memory_order_relaxed); break;
+                case invalid_iterator::MODERATE: ++counters.moderate_faults; g.moderate_faults.fetch_add(1, std::memory_order_relaxed); break;
+                default:                         ++counters.mild_faults; g.mild_faults.fetch_add(1, std::memory_order_relaxed); break;
+            }
+#else
+            (void) level;
+#endif
+        }
+        
+        void deallocate(T* p, uint64_t capacity) {
+            alloc_traits::deallocate(alloc, p, capacity);
+        }
+        
+        bool is_inline(void) const {
+            return InlineCapacity != 0 && cap_start == this->inline_data();
+        }
+        
+        // points the vector at an empty buffer with room for at least
+        // capacity elements, preferring the inline buffer when it fits
+        void init_storage(uint64_t capacity) {
+            if (InlineCapacity != 0 && capacity <= InlineCapacity) {
+                capacity = InlineCapacity;
+                cap_start = this->inline_data();
+            } else {
+                if (capacity < Growth::minimum_capacity) { capacity = Growth::minimum_capacity; }
+                cap_start = allocate(capacity);
+            }
+            cap_finish = cap_start + capacity;
+            data_start = data_end = cap_start;
+        }
+        
+        // hands the current buffer back to the allocator unless it is inline
+        void release_storage(void) {
+            if (cap_start != nullptr && !is_inline()) { deallocate(cap_start, cap_finish - cap_start); }
+        }
+        
+        // the buffer is only torn down by its last owner
         void destroy(void) {
+            if (owners != nullptr) {
+                bool last = owners->count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+                if (last) { delete owners; }
+                owners = nullptr;
+                if (!last) { return; }
+            }
             if (cap_start != nullptr) {
                 while (data_start != data_end) {
-                    data_start->~T();
+                    alloc_traits::destroy(alloc, data_start);
                     ++data_start;
                 }
-                operator delete(cap_start);
+                release_storage();
             }
         }
         
-        void copy(const vector<T>& that) {
-            uint64_t capacity = that.size();
-            if (capacity < minimum_capacity) { capacity = minimum_capacity; }
-            cap_start = static_cast<T*>(operator new(capacity * sizeof(T)));
-            data_start = data_end = cap_start;
-            for (uint64_t i = 0; i < that.size(); i += 1) {
-                new (data_end) T(that[i]);
-                ++data_end;
+        // points a vector whose buffer is gone at an empty one of its own
+        void make_empty(void) {
+            owners = nullptr;
+            if (InlineCapacity != 0) {
+                init_storage(0);
+                data_start = data_end = cap_start + InlineCapacity / 2;
+            } else {
+                cap_start = cap_finish = data_start = data_end = nullptr;
             }
         }
         
-        void move(vector<T>&& that) {
-            cap_start = that.cap_start;
-            cap_finish = that.cap_finish;
-            data_start = that.data_start;
-            data_end = that.data_end;
-            that.cap_start = that.cap_finish = that.data_start = that.data_end = nullptr;
+        // on an empty vector; if an element's copy throws, it stays empty
+        void copy(const vector& that) {
+            if (that.shareable() && alloc == that.alloc) {
+                that.owners->count.fetch_add(1, std::memory_order_relaxed);
+                owners = that.owners;
+                cap_start = that.cap_start;
+                cap_finish = that.cap_finish;
+                data_start = that.data_start;
+                data_end = that.data_end;
+                return;
+            }
+            std::unique_ptr<detail::owner_count> fresh(that.owners != nullptr ? new detail::owner_count() : nullptr);
+            init_storage(that.size());
+            try {
+                data_end = construct_range(data_start, static_cast<const T*>(that.data_start), static_cast<const T*>(that.data_end));
+            } catch (...) {
+                release_storage();
+                make_empty();
+                throw;
+            }
+            owners = fresh.release();
         }
         
-        template <typename Iterator>
-        void constructFromIterator(Iterator start, Iterator finish, std::random_access_iterator_tag) {
-            uint64_t capacity = (uint64_t) (finish - start);
-            if (capacity < minimum_capacity) { capacity = minimum_capacity; }
-            cap_start = static_cast<T*>(operator new(capacity * sizeof(T)));
-            data_start = data_end = cap_start;
-            while (start != finish) {
-                new (data_end) T(*start);
-                ++data_end;
-                ++start;
+        void move(vector&& that) {
+            if (that.is_inline()) {
+                // inline elements cannot change owner, transfer them into our
+                // own buffer; if that throws, this vector is empty and that
+                // one keeps its elements
+                init_storage(0);
+                T* new_data = cap_start + (that.data_start - that.cap_start);
+                data_end = transfer(that.data_start, that.data_end, new_data, nothrow_relocatable{});
+                data_start = new_data;
+                that.data_start = that.data_end = that.cap_start + InlineCapacity / 2;
+                owners = that.owners;
+                that.owners = nullptr;
+            } else {
+                owners = that.owners;
+                that.owners = nullptr;
+                cap_start = that.cap_start;
+                cap_finish = that.cap_finish;
+                data_start = that.data_start;
+                data_end = that.data_end;
+                that.make_empty();
+            }
+            that.modified();
+            that.resized();
+        }
+        
+        void move_assign(vector&& that, std::true_type) {
+            alloc = std::move(that.alloc);
+            move(std::move(that));
+        }
+        
+        // the allocator stays behind, so the buffer can only be taken over
+        // when both allocators can free each other's memory; otherwise the
+        // elements are moved one by one and a throw leaves this vector empty
+        void move_assign(vector&& that, std::false_type) {
+            if (alloc == that.alloc) {
+                move(std::move(that));
+                return;
+            }
+            init_storage(that.size());
+            try {
+                data_end = construct_range(data_start, std::make_move_iterator(static_cast<T*>(that.data_start)),
+                                           std::make_move_iterator(static_cast<T*>(that.data_end)));
+                if (that.owners != nullptr) { owners = new detail::owner_count(); }
+            } catch (...) {
+                destroy_range(data_start, data_end);
+                release_storage();
+                make_empty();
+                throw;
             }
         }
         
         template <typename Iterator>
         void constructFromIterator(Iterator start, Iterator finish, std::forward_iterator_tag) {
-            uint64_t capacity = minimum_capacity;
-            cap_start = static_cast<T*>(operator new(capacity * sizeof(T)));
+            init_storage((uint64_t) std::distance(start, finish));
+            try {
+                data_end = construct_range(data_start, start, finish);
+            } catch (...) {
+                release_storage();
+                throw;
+            }
+        }
+        
+        template <typename Iterator>
+        void constructFromIterator(Iterator start, Iterator finish, std::input_iterator_tag) {
+            init_storage(0);
+            try {
+                while (start != finish) {
+                    push_back(*start);
+                    ++start;
+                }
+            } catch (...) {
+                destroy();
+                throw;
+            }
+        }
+        
+        template <typename Iterator>
+        void assign(Iterator first, Iterator last, std::forward_iterator_tag) {
+            uint64_t n = std::distance(first, last);
+            destroy_range(data_start, data_end);
+            if (n > capacity()) {
+                release_storage();
+                cap_start = cap_finish = data_start = data_end = nullptr;
+                init_storage(n);
+            } else {
+                data_start = data_end = cap_start;
+            }
+            data_end = construct_range(data_start, first, last);
+            resized();
+            modified();
+        }
+        
+        template <typename Iterator>
+        void assign(Iterator first, Iterator last, std::input_iterator_tag) {
+            destroy_range(data_start, data_end);
             data_start = data_end = cap_start;
-            while (start != finish) {
-                push_back(*start);
-                ++start;
+            modified();
+            append(first, last, std::input_iterator_tag{});
+        }
+        
+        template <typename Iterator>
+        void append(Iterator first, Iterator last, std::forward_iterator_tag) {
+            check_back((uint64_t) std::distance(first, last));
+            data_end = construct_range(data_end, first, last);
+            modified();
+        }
+        
+        template <typename Iterator>
+        void append(Iterator first, Iterator last, std::input_iterator_tag) {
+            while (first != last) {
+                emplace_back(*first);
+                ++first;
             }
         }
         
+        template <typename Iterator>
+        void prepend(Iterator first, Iterator last, std::forward_iterator_tag) {
+            uint64_t n = std::distance(first, last);
+            check_front(n);
+            construct_range(data_start - n, first, last);
+            data_start -= n;
+            modified();
+        }
+        
+        template <typename Iterator>
+        void prepend(Iterator first, Iterator last, std::input_iterator_tag) {
+            // the length is unknown until the range is consumed, so stage it
+            // at the back and rotate it to the front
+            uint64_t old_size = size();
+            append(first, last, std::input_iterator_tag{});
+            std::rotate(data_start, data_start + old_size, data_end);
+        }
+        
+        // copy-constructs [first, last) into the uninitialized storage at dest
+        // and returns one past the last element built; if a constructor
+        // throws, whatever was built is destroyed again
+        template <typename Iterator>
+        T* construct_range(T* dest, Iterator first, Iterator last) {
+            typedef typename std::remove_cv<typename std::remove_reference<decltype(*first)>::type>::type source_type;
+            return construct_range(dest, first, last, std::integral_constant<bool,
+                                   std::is_pointer<Iterator>::value && std::is_same<source_type, T>::value && std::is_trivially_copyable<T>::value>{});
+        }
+        
+        template <typename Iterator>
+        T* construct_range(T* dest, Iterator first, Iterator last, std::true_type) {
+            uint64_t n = last - first;
+            if (n != 0) { std::memcpy(static_cast<void*>(dest), static_cast<const void*>(first), n * sizeof(T)); }
+            return dest + n;
+        }
+        
+        template <typename Iterator>
+        T* construct_range(T* dest, Iterator first, Iterator last, std::false_type) {
+            T* p = dest;
+            try {
+                for (; first != last; ++first, ++p) {
+                    alloc_traits::construct(alloc, p, *first);
+                }
+            } catch (...) {
+                destroy_range(dest, p);
+                throw;
+            }
+            return p;
+        }
+        
+        void destroy_range(T* first, T* last) {
+            for (; first != last; ++first) {
+                alloc_traits::destroy(alloc, first);
+            }
+        }
+        
+        // moves [first, last) into the uninitialized storage at dest and ends the
+        // lifetime of the originals; returns one past the last relocated element.
+        // The ranges may overlap as long as dest is not after first.
+        T* relocate(T* first, T* last, T* dest, std::true_type) {
+            uint64_t n = last - first;
+            if (n != 0) { std::memmove(static_cast<void*>(dest), static_cast<const void*>(first), n * sizeof(T)); }
+            return dest + n;
+        }
+        
+        T* relocate(T* first, T* last, T* dest, std::false_type) {
+            while (first != last) {
+                alloc_traits::construct(alloc, dest, std::move(*first));
+                alloc_traits::destroy(alloc, first);
+                ++first;
+                ++dest;
+            }
+            return dest;
+        }
+        
+        // like relocate, but fills [dest_end - (last - first), dest_end) from
+        // the back so that the ranges may overlap with dest_end > last;
+        // relocate itself handles overlap when dest < first
+        T* relocate_backward(T* first, T* last, T* dest_end, std::true_type) {
+            uint64_t n = last - first;
+            if (n != 0) { std::memmove(static_cast<void*>(dest_end - n), static_cast<const void*>(first), n * sizeof(T)); }
+            return dest_end;
+        }
+        
+        T* relocate_backward(T* first, T* last, T* dest_end, std::false_type) {
+            T* dest = dest_end;
+            while (first != last) {
+                --last;
+                --dest;
+                alloc_traits::construct(alloc, dest, std::move(*last));
+                alloc_traits::destroy(alloc, last);
+            }
+            return dest_end;
+        }
+        
         void check_back(uint64_t back_capacity) {
             if (back_capacity <= (uint64_t) (cap_finish - data_end)) {
                 return;
             }
-            
-            uint64_t capacity = 2 * (cap_finish - cap_start);
-            
-            while (capacity < back_capacity) {
-                capacity *= 2;
+            if (recenter(back_capacity)) {
+                return;
             }
             
-            uint64_t excess_capacity = capacity - size();
-            if (back_capacity < excess_capacity / 2) { back_capacity = excess_capacity / 2; }
-            
-            T* new_address = static_cast<T*>(operator new(sizeof(T) * capacity));
-            T* new_data = new_address + capacity - back_capacity - size();
-            T* new_data_end = new_data;
+            uint64_t capacity = Growth::grow(cap_finish - cap_start, size() + back_capacity, sizeof(T));
+            uint64_t front_room = Growth::front_room(capacity - size(), 0, back_capacity, data_start - cap_start, cap_finish - data_end);
+            if (remappable::value) {
+                // the buffer can be grown in place, so keep the front where it is
+                // rather than paying for a memmove to rebalance the ends
+                uint64_t old_front_room = data_start - cap_start;
+                if (old_front_room < front_room) { front_room = old_front_room; }
+            }
+            count(&vector_stats::back_reallocations, &detail::global_stats::back_reallocations);
+            reallocate(capacity, front_room);
+        }
+        
+        void check_front(uint64_t front_capacity) {
+            if (front_capacity <= (uint64_t) (data_start - cap_start)) {
+                return;
+            }
+            if (recenter(front_capacity)) {
+                return;
+            }
             
-            while (data_start != data_end) {
-                new (new_data_end) T(std::move(*data_start));
-                data_start->~T();
-                ++data_start;
-                ++new_data_end;
+            uint64_t capacity = Growth::grow(cap_finish - cap_start, size() + front_capacity, sizeof(T));
+            uint64_t front_room = Growth::front_room(capacity - size(), front_capacity, 0, data_start - cap_start, cap_finish - data_end);
+            count(&vector_stats::front_reallocations, &detail::global_stats::front_reallocations);
+            reallocate(capacity, front_room);
+        }
+        
+        // When one end is full but at least half of the buffer is free the
+        // elements are slid back to the middle instead of growing, so a
+        // queue (push_back + pop_front) runs in a fixed buffer.  Requiring
+        // half the buffer to be free leaves a quarter of it at each end
+        // afterwards, which keeps the amortized cost of sliding constant.
+        bool recenter(uint64_t needed) {
+            uint64_t capacity = cap_finish - cap_start;
+            if (size() + needed > capacity / 2) {
+                return false;
+            }
+            if (!nothrow_relocatable::value) {
+                // sliding in place could fail halfway, so copy into a buffer of the same size
+                reallocate(capacity, (capacity - size()) / 2);
+                count(&vector_stats::recenters, &detail::global_stats::recenters);
+                return true;
+            }
+            T* new_data = cap_start + (capacity - size()) / 2;
+            if (new_data < data_start) {
+                data_end = relocate(data_start, data_end, new_data, is_trivially_relocatable<T>{});
+            } else {
+                data_end = relocate_backward(data_start, data_end, new_data + size(), is_trivially_relocatable<T>{});
+            }
+            data_start = new_data;
+            count(&vector_stats::recenters, &detail::global_stats::recenters);
+            count_relocation(size());
+            resized();
+            return true;
+        }
+        
+        // halves the buffer once it is less than a quarter full; skipped
+        // for types whose move may throw, since pop must not fail halfway
+        void check_shrink(void) {
+            uint64_t capacity = cap_finish - cap_start;
+            if (is_inline() || capacity <= Growth::minimum_capacity || size() >= capacity / 4) {
+                return;
             }
-            operator delete(cap_start);
+            if (!is_trivially_relocatable<T>::value && !std::is_nothrow_move_constructible<T>::value) {
+                return;
+            }
+            uint64_t new_capacity = capacity / 2;
+            if (new_capacity < Growth::minimum_capacity) { new_capacity = Growth::minimum_capacity; }
+            try {
+                reallocate(new_capacity, (new_capacity - size()) / 2);
+                count(&vector_stats::shrinks, &detail::global_stats::shrinks);
+            } catch (std::bad_alloc&) {
+                // keeping the larger buffer is fine
+            }
+        }
+        
+        // moves the elements into a new buffer of the given capacity, leaving
+        // front_room free slots ahead of them
+        void reallocate(uint64_t capacity, uint64_t front_room) {
+            if (remappable::value && cap_start != nullptr && !is_inline()) {
+                if (remap(capacity, front_room, remappable{})) { return; }
+            }
+            T* new_address = allocate(capacity);
+            T* new_data = new_address + front_room;
+            T* new_data_end;
+            try {
+                new_data_end = transfer(data_start, data_end, new_data, nothrow_relocatable{});
+            } catch (...) {
+                deallocate(new_address, capacity);
+                throw;
+            }
+            count_relocation(size());
+            release_storage();
             
             cap_start = new_address;
             cap_finish = cap_start + capacity;
             data_start = new_data;
             data_end = new_data_end;
             
-            ++resize_version;
+            resized();
         }
         
-        void check_front(uint64_t front_capacity) {
-            if (front_capacity <= (uint64_t) (data_start - cap_start)) {
-                return;
+        // Elements whose move constructor may throw are copied into a new
+        // buffer instead (as std::move_if_noexcept would choose) and the
+        // originals destroyed only once every copy has succeeded, so growth
+        // either completes or leaves the vector as it was.  Move-only types
+        // with a throwing move are moved the same way: if a move throws, the
+        // originals are all still there, though some are moved-from.
+        using nothrow_relocatable = std::integral_constant<bool, is_trivially_relocatable<T>::value ||
+            std::is_nothrow_move_constructible<T>::value>;
+        
+        using transfer_source = typename std::conditional<std::is_copy_constructible<T>::value, const T*, std::move_iterator<T*>>::type;
+        
+        T* transfer(T* first, T* last, T* dest, std::true_type) {
+            return relocate(first, last, dest, is_trivially_relocatable<T>{});
+        }
+        
+        T* transfer(T* first, T* last, T* dest, std::false_type) {
+            T* dest_end = construct_range(dest, transfer_source(first), transfer_source(last));
+            destroy_range(first, last);
+            return dest_end;
+        }
+        
+        using remappable = std::integral_constant<bool, is_trivially_relocatable<T>::value && detail::has_reallocate<Alloc>::value>;
+        
+        // grows or shrinks the buffer through the allocator's reallocate hook
+        // (e.g. mremap), so the elements never pass through a second buffer
+        bool remap(uint64_t capacity, uint64_t front_room, std::true_type) {
+            uint64_t old_front_room = data_start - cap_start;
+            uint64_t n = size();
+            if (capacity < (uint64_t) (cap_finish - cap_start) && old_front_room + n > capacity) {
+                // shrinking would cut off live elements, pull them to the front first
+                relocate(data_start, data_end, cap_start, std::true_type{});
+                old_front_room = 0;
             }
-            
-            uint64_t capacity = 2 * (cap_finish - cap_start);
-            
-            while (capacity < front_capacity) {
-                capacity *= 2;
+            T* new_address = alloc.reallocate(cap_start, cap_finish - cap_start, capacity);
+            if (new_address == nullptr) {
+                if (old_front_room == 0) { data_start = cap_start; data_end = cap_start + n; }
+                return false;
             }
-            
-            uint64_t excess_capacity = capacity - size();
-            if (front_capacity < excess_capacity / 2) { front_capacity = excess_capacity / 2; }
-            
-            T* new_address = static_cast<T*>(operator new(sizeof(T) * capacity));
-            T* new_data = new_address + front_capacity;
-            T* new_data_end = new_data;
-            
-            while (data_start != data_end) {
-                new (new_data_end) T(std::move(*data_start));
-                data_start->~T();
-                ++data_start;
-                ++new_data_end;
+            T* old_data = new_address + old_front_room;
+            T* new_data = new_address + front_room;
+            if (new_data != old_data) {
+                std::memmove(static_cast<void*>(new_data), static_cast<const void*>(old_data), n * sizeof(T));
+                count_relocation(n);
             }
-            operator delete(cap_start);
+            count_allocation(capacity);
             
             cap_start = new_address;
             cap_finish = cap_start + capacity;
             data_start = new_data;
-            data_end = new_data_end;
+            data_end = new_data + n;
             
-            ++resize_version;
+            resized();
+            return true;
+        }
+        
+        bool remap(uint64_t, uint64_t, std::false_type) {
+            return false;
+        }
+        
+        void discard_slack(std::true_type) {
+            if (cap_start == nullptr || is_inline()) { return; }
+            alloc.discard(cap_start, data_start - cap_start);
+            alloc.discard(data_end, cap_finish - data_end);
+        }
+        
+        void discard_slack(std::false_type) {
         }
         
     };
     
     
+    template <typename T, std::size_t N, typename Checking = default_checking, typename Alloc = std::allocator<T>, typename Growth = double_growth>
+    using small_vector = vector<T, Checking, Alloc, N, Growth>;
+    
 } //namespace epl
 
 #endif
@@ -0,0 +1,126 @@
+/*
+ * Vector_Algorithm_unittests.cpp
+ *
+ * Runs the standard <algorithm> and <numeric> suites against epl::vector with
+ * both checking policies.  The iterators must satisfy the random access
+ * iterator requirements (and, in C++20, std::contiguous_iterator) for these
+ * to compile and pick their optimized overloads.
+ */
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "Vector.h"
+
+using epl::vector;
+
+namespace {
+    template <typename V>
+    V scrambled(int n) {
+        V x;
+        for (int k = 0; k < n; ++k) {
+            x.push_back((k * 7919) % n);
+        }
+        return x;
+    }
+} //namespace
+
+#if __cplusplus >= 202002L
+static_assert(std::contiguous_iterator<vector<int, epl::checked>::iterator>, "checked iterator");
+static_assert(std::contiguous_iterator<vector<int, epl::checked>::const_iterator>, "checked const_iterator");
+static_assert(std::contiguous_iterator<vector<int, epl::unchecked>::iterator>, "unchecked iterator");
+static_assert(std::ranges::contiguous_range<vector<int, epl::checked>>, "checked vector");
+#endif
+
+template <typename V>
+class Algorithm : public ::testing::Test {};
+
+typedef ::testing::Types<vector<int, epl::checked>, vector<int, epl::unchecked>> Policies;
+TYPED_TEST_SUITE(Algorithm, Policies);
+
+TYPED_TEST(Algorithm, IteratorArithmetic) {
+    TypeParam x = scrambled<TypeParam>(10);
+    auto b = x.begin();
+    auto e = x.end();
+
+    EXPECT_EQ(10, e - b);
+    EXPECT_TRUE(b < e);
+    EXPECT_TRUE(b <= b);
+    EXPECT_TRUE(e > b);
+    EXPECT_TRUE(e >= e);
+
+    auto m = b + 4;
+    EXPECT_EQ(4, m - b); // operator+ must not move b
+    EXPECT_EQ(m, 4 + b);
+    EXPECT_EQ(b, m - 4);
+    m += 2;
+    EXPECT_EQ(x[6], *m);
+    m -= 6;
+    EXPECT_EQ(b, m);
+    EXPECT_EQ(x[3], b[3]);
+
+    const TypeParam& cx = x;
+    static_assert(std::is_same<decltype(cx.begin()[0]), const int&>::value, "const_iterator[] must be read-only");
+    EXPECT_EQ(x.data(), &*cx.begin());
+}
+
+TYPED_TEST(Algorithm, Sort) {
+    TypeParam x = scrambled<TypeParam>(1000);
+    std::sort(x.begin(), x.end());
+    EXPECT_TRUE(std::is_sorted(x.begin(), x.end()));
+    for (int k = 0; k < 1000; ++k) {
+        EXPECT_EQ(k, x[k]);
+    }
+
+    std::stable_sort(x.begin(), x.end(), std::greater<int>());
+    EXPECT_EQ(999, x.front());
+    EXPECT_EQ(0, x.back());
+}
+
+TYPED_TEST(Algorithm, Search) {
+    TypeParam x = scrambled<TypeParam>(100);
+    std::sort(x.begin(), x.end());
+
+    auto lb = std::lower_bound(x.begin(), x.end(), 42);
+    EXPECT_EQ(42, lb - x.begin());
+    EXPECT_TRUE(std::binary_search(x.begin(), x.end(), 99));
+    EXPECT_EQ(x.end(), std::find(x.begin(), x.end(), 100));
+    EXPECT_EQ(17, *std::find(x.begin(), x.end(), 17));
+    EXPECT_EQ(1, std::count(x.begin(), x.end(), 5));
+}
+
+TYPED_TEST(Algorithm, CopyAndTransform) {
+    TypeParam x = scrambled<TypeParam>(50);
+    TypeParam y(50);
+
+    std::copy(x.begin(), x.end(), y.begin());
+    EXPECT_TRUE(std::equal(x.begin(), x.end(), y.begin()));
+
+    std::transform(x.begin(), x.end(), y.begin(), [](int v) { return 2 * v; });
+    EXPECT_EQ(2 * x[7], y[7]);
+
+    std::reverse(y.begin(), y.end());
+    EXPECT_EQ(2 * x[0], y[49]);
+
+    std::iota(y.begin(), y.end(), 0);
+    EXPECT_EQ(49 * 50 / 2, std::accumulate(y.begin(), y.end(), 0));
+
+    std::nth_element(x.begin(), x.begin() + 25, x.end());
+    EXPECT_EQ(25, x[25]);
+
+    std::make_heap(x.begin(), x.end());
+    EXPECT_EQ(49, x.front());
+}
+
+#if __cplusplus >= 202002L
+TYPED_TEST(Algorithm, Ranges) {
+    TypeParam x = scrambled<TypeParam>(100);
+    std::ranges::sort(x);
+    EXPECT_TRUE(std::ranges::is_sorted(x));
+    EXPECT_EQ(x.data() + 10, std::to_address(std::ranges::find(x, 10)));
+}
+#endif
@@ -0,0 +1,184 @@
+/*
+ * Vector_Allocator_unittests.cpp
+ *
+ * Tests for the allocator parameter of epl::vector and for the arena and pool
+ * allocators in Allocators.h.
+ */
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "Allocators.h"
+#include "Vector.h"
+
+using epl::vector;
+
+namespace {
+    // stateful allocator that tags its memory with an id and counts traffic
+    struct Counters {
+        uint64_t allocations = 0;
+        uint64_t deallocations = 0;
+    };
+
+    template <typename T>
+    class CountingAllocator {
+    public:
+        using value_type = T;
+        using propagate_on_container_move_assignment = std::false_type;
+
+        Counters* counters;
+
+        CountingAllocator(Counters& counters) : counters(&counters) {}
+        template <typename U>
+        CountingAllocator(const CountingAllocator<U>& that) : counters(that.counters) {}
+
+        T* allocate(size_t n) { ++counters->allocations; return static_cast<T*>(operator new(n * sizeof(T))); }
+        void deallocate(T* p, size_t) { ++counters->deallocations; operator delete(p); }
+
+        template <typename U>
+        bool operator==(const CountingAllocator<U>& that) const { return counters == that.counters; }
+        template <typename U>
+        bool operator!=(const CountingAllocator<U>& that) const { return counters != that.counters; }
+    };
+
+    // the move constructor throws once moves_left runs out
+    struct ThrowsOnMove {
+        static int moves_left;
+        std::string s;
+
+        ThrowsOnMove(const char* s) : s(s) {}
+        ThrowsOnMove(const ThrowsOnMove& that) : s(that.s) {}
+        ThrowsOnMove(ThrowsOnMove&& that) : s(that.s) {
+            if (moves_left-- == 0) { throw std::runtime_error("move failed"); }
+        }
+    };
+    int ThrowsOnMove::moves_left = 1000;
+} //namespace
+
+TEST(Allocator, AllStorageGoesThroughAllocator) {
+    Counters c;
+    {
+        vector<int, epl::checked, CountingAllocator<int>> x{ CountingAllocator<int>(c) };
+        for (int k = 0; k < 100; ++k) {
+            x.push_back(k);
+            x.push_front(k);
+        }
+        vector<int, epl::checked, CountingAllocator<int>> y(x);
+        EXPECT_EQ(200, y.size());
+    }
+    EXPECT_LT(2, c.allocations);
+    EXPECT_EQ(c.allocations, c.deallocations);
+}
+
+TEST(Allocator, MoveAssignWithUnequalAllocators) {
+    Counters a, b;
+    typedef vector<std::string, epl::checked, CountingAllocator<std::string>> V;
+    {
+        V x{ CountingAllocator<std::string>(a) };
+        V y{ CountingAllocator<std::string>(b) };
+        x.push_back("hello");
+        y = std::move(x); // allocator does not propagate, so elements are moved one by one
+
+        EXPECT_EQ(1, y.size());
+        EXPECT_EQ("hello", y[0]);
+        EXPECT_TRUE(y.get_allocator() == CountingAllocator<std::string>(b));
+    }
+    EXPECT_EQ(a.allocations, a.deallocations);
+    EXPECT_EQ(b.allocations, b.deallocations);
+}
+
+TEST(Allocator, ThrowingMoveAssignLeavesEmpty) {
+    Counters a, b;
+    typedef vector<ThrowsOnMove, epl::checked, CountingAllocator<ThrowsOnMove>> V;
+    {
+        V x{ CountingAllocator<ThrowsOnMove>(a) };
+        V y{ CountingAllocator<ThrowsOnMove>(b) };
+        x.push_back("one");
+        x.push_back("two");
+        x.push_back("three");
+        y.push_back("old");
+        ThrowsOnMove::moves_left = 1;
+        EXPECT_THROW(y = std::move(x), std::runtime_error);
+        ThrowsOnMove::moves_left = 1000;
+
+        EXPECT_EQ(0, y.size());
+        y.push_back("new");
+        EXPECT_EQ("new", y[0].s);
+    }
+    EXPECT_EQ(a.allocations, a.deallocations);
+    EXPECT_EQ(b.allocations, b.deallocations);
+}
+
+TEST(Allocator, ArenaBacksVector) {
+    char buffer[4096];
+    epl::arena arena(buffer, sizeof(buffer));
+    {
+        vector<int, epl::checked, epl::arena_allocator<int>> x{ epl::arena_allocator<int>(arena) };
+        for (int k = 0; k < 10000; ++k) {
+            x.push_back(k); // outgrows the buffer and continues on heap blocks
+        }
+        for (int k = 0; k < 10000; ++k) {
+            EXPECT_EQ(k, x[k]);
+        }
+
+        vector<int, epl::checked, epl::arena_allocator<int>> y{ epl::arena_allocator<int>(arena) };
+        y = std::move(x);
+        EXPECT_EQ(10000, y.size());
+    }
+    arena.release();
+
+    void* p = arena.allocate(16);
+    EXPECT_EQ(static_cast<void*>(buffer), p); // back to the caller's buffer after release
+}
+
+TEST(Allocator, PoolRecyclesBlocks) {
+    epl::pool pool;
+    int* first;
+    {
+        vector<int, epl::checked, epl::pool_allocator<int>> x{ epl::pool_allocator<int>(pool) };
+        x.push_back(1);
+        first = x.data();
+    }
+    {
+        vector<int, epl::checked, epl::pool_allocator<int>> y{ epl::pool_allocator<int>(pool) };
+        y.push_back(2);
+        EXPECT_EQ(first, y.data()); // same size class, same block
+    }
+
+    void* big = pool.allocate(epl::pool::max_pooled_size() + 1);
+    pool.deallocate(big, epl::pool::max_pooled_size() + 1);
+}
+
+TEST(Allocator, MmapBackedGrowth) {
+    // a 64 KiB threshold so that the test maps without needing gigabytes
+    typedef epl::mmap_allocator<uint64_t, 64 * 1024> Mapped;
+    static_assert(epl::detail::has_reallocate<Mapped>::value, "mmap_allocator should expose reallocate");
+
+    vector<uint64_t, epl::unchecked, Mapped> x;
+    for (uint64_t k = 0; k < 1000000; ++k) {
+        x.push_back(k);
+    }
+    for (uint64_t k = 0; k < 1000; ++k) {
+        x.push_front(k);
+    }
+    ASSERT_EQ(1001000, x.size());
+    EXPECT_EQ(999, x[0]);
+    EXPECT_EQ(0, x[1000]);
+    EXPECT_EQ(999999, x.back());
+
+    for (uint64_t k = 0; k < 600000; ++k) {
+        x.pop_front();
+    }
+    x.release_slack(); // the popped pages go back to the system
+    EXPECT_EQ(599000, x.front());
+    EXPECT_EQ(999999, x.back());
+    x.push_front(7); // and come back as zero pages when reused
+    EXPECT_EQ(7, x.front());
+
+    x.shrink_to_fit();
+    EXPECT_EQ(401001, x.size());
+    EXPECT_EQ(599000, x[1]);
+    EXPECT_EQ(999999, x.back());
+}
@@ -0,0 +1,224 @@
+/*
+ * Vector_Bulk_unittests.cpp
+ *
+ * Tests for the bulk operations of epl::vector: reserve, reserve_front,
+ * resize, assign, append, prepend, range insert and erase.  Each of them should
+ * reallocate at most once no matter how many elements it adds.  The Capacity
+ * tests cover recentering and shrinking of the buffer.
+ */
+
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "Vector.h"
+
+namespace {
+    uint64_t allocations = 0;
+
+    template <typename T>
+    class CountingAllocator : public std::allocator<T> {
+    public:
+        template <typename U> struct rebind { typedef CountingAllocator<U> other; };
+
+        CountingAllocator(void) {}
+        template <typename U>
+        CountingAllocator(const CountingAllocator<U>&) {}
+
+        T* allocate(size_t n) { ++allocations; return std::allocator<T>::allocate(n); }
+    };
+
+    typedef epl::vector<int, epl::checked, CountingAllocator<int>> vector;
+
+    std::vector<int> iota(int first, int n) {
+        std::vector<int> v;
+        for (int k = 0; k < n; ++k) { v.push_back(first + k); }
+        return v;
+    }
+
+    template <typename V>
+    std::vector<int> contents(const V& x) {
+        return std::vector<int>(x.begin(), x.end());
+    }
+} //namespace
+
+TEST(Bulk, ReserveBothEnds) {
+    vector x;
+    allocations = 0;
+    x.reserve(1000);
+    EXPECT_LE(1000, x.capacity());
+    for (int k = 0; k < 1000; ++k) { x.push_back(k); }
+
+    x.reserve_front(3000);
+    for (int k = 0; k < 2000; ++k) { x.push_front(k); }
+    EXPECT_EQ(2, allocations);
+    EXPECT_EQ(3000, x.size());
+}
+
+TEST(Bulk, Resize) {
+    vector x;
+    x.resize(10);
+    EXPECT_EQ(10, x.size());
+    EXPECT_EQ(0, x[9]);
+    x[9] = 9;
+    x.resize(5);
+    EXPECT_EQ(5, x.size());
+    x.resize(20);
+    EXPECT_EQ(0, x[9]); // newly value-initialized
+}
+
+TEST(Bulk, AppendAllocatesOnce) {
+    std::vector<int> src = iota(0, 100000);
+    vector x;
+    x.push_back(-1);
+    allocations = 0;
+    x.append(src.begin(), src.end());
+    EXPECT_EQ(1, allocations);
+    EXPECT_EQ(100001, x.size());
+    EXPECT_EQ(99999, x.back());
+
+    std::list<int> more(5, 7); // bidirectional, not random access
+    x.append(more.begin(), more.end());
+    EXPECT_EQ(7, x.back());
+}
+
+TEST(Bulk, PrependKeepsOrder) {
+    vector x;
+    x.push_back(100);
+    std::vector<int> src = iota(0, 50);
+    allocations = 0;
+    x.prepend(src.begin(), src.end());
+    EXPECT_EQ(1, allocations);
+
+    std::vector<int> expected = iota(0, 50);
+    expected.push_back(100);
+    EXPECT_EQ(expected, contents(x));
+
+    std::istringstream in("1 2 3");
+    x.prepend(std::istream_iterator<int>(in), std::istream_iterator<int>());
+    EXPECT_EQ(1, x[0]);
+    EXPECT_EQ(3, x[2]);
+    EXPECT_EQ(0, x[3]);
+}
+
+TEST(Bulk, AssignAndConstruct) {
+    std::vector<int> src = iota(5, 1000);
+    allocations = 0;
+    vector x(src.begin(), src.end());
+    EXPECT_EQ(1, allocations);
+    EXPECT_EQ(src, contents(x));
+
+    std::list<int> small(3, 1);
+    x.assign(small.begin(), small.end());
+    EXPECT_EQ(1, allocations); // fits in the existing buffer
+    EXPECT_EQ(3, x.size());
+
+    std::istringstream in("4 5 6");
+    x.assign(std::istream_iterator<int>(in), std::istream_iterator<int>());
+    EXPECT_EQ((std::vector<int>{ 4, 5, 6 }), contents(x));
+}
+
+TEST(Bulk, InsertInMiddle) {
+    epl::vector<std::string> x{ "a", "b", "c", "d", "e", "f" };
+    std::vector<std::string> near_front{ "1", "2" };
+    std::vector<std::string> near_back{ "8", "9" };
+
+    auto it = x.insert(x.begin() + 1, near_front.begin(), near_front.end());
+    EXPECT_EQ("1", *it);
+    it = x.insert(x.end() - 1, near_back.begin(), near_back.end());
+    EXPECT_EQ("8", *it);
+
+    std::vector<std::string> expected{ "a", "1", "2", "b", "c", "d", "e", "8", "9", "f" };
+    EXPECT_EQ(expected, std::vector<std::string>(x.begin(), x.end()));
+}
+
+TEST(Bulk, EraseFromNearerEnd) {
+    epl::vector<std::string> x{ "a", "b", "c", "d", "e", "f", "g", "h" };
+    const epl::vector<std::string>& cx = x;
+    const std::string* first = cx.data();
+    const std::string* last = cx.data() + 7;
+
+    auto it = x.erase(x.begin() + 1, x.begin() + 3); // the front closes the gap
+    EXPECT_EQ("d", *it);
+    EXPECT_EQ(first + 2, cx.data());
+    it = x.erase(x.end() - 2); // the back closes the gap
+    EXPECT_EQ("h", *it);
+    EXPECT_EQ(last - 1, cx.data() + cx.size() - 1);
+
+    std::vector<std::string> expected{ "a", "d", "e", "f", "h" };
+    EXPECT_EQ(expected, std::vector<std::string>(x.begin(), x.end()));
+    x.erase(x.begin(), x.end());
+    EXPECT_EQ(0, x.size());
+}
+
+TEST(Capacity, QueueRecentersInPlace) {
+    epl::vector<std::string> q;
+    for (int k = 0; k < 100; ++k) { q.push_back(std::to_string(k)); }
+    uint64_t capacity = q.capacity();
+
+    for (int k = 100; k < 100000; ++k) {
+        q.push_back(std::to_string(k));
+        q.pop_front();
+    }
+    EXPECT_EQ(capacity, q.capacity());
+    EXPECT_EQ("99900", q.front());
+    EXPECT_EQ("99999", q.back());
+
+    for (int k = 0; k < 100000; ++k) { // and the other way round
+        q.push_front(std::to_string(k));
+        q.pop_back();
+    }
+    EXPECT_EQ(capacity, q.capacity());
+    EXPECT_EQ("99999", q.front());
+    EXPECT_EQ("99900", q.back());
+}
+
+TEST(Capacity, RecenterInvalidatesIterators) {
+    epl::vector<int, epl::checked> q;
+    for (int k = 0; k < 8; ++k) { q.push_back(k); }
+    for (int k = 0; k < 6; ++k) { q.pop_front(); }
+    auto it = q.begin();
+    q.push_back(8); // back is full, front has room: slide instead of grow
+    EXPECT_EQ(8, q.capacity());
+    try {
+        *it;
+        FAIL() << "expected invalid_iterator";
+    } catch (epl::invalid_iterator& e) {
+        EXPECT_EQ(epl::invalid_iterator::MODERATE, e.level);
+    }
+    EXPECT_EQ(6, q[0]);
+    EXPECT_EQ(8, q[2]);
+}
+
+TEST(Capacity, ShrinkToFit) {
+    vector x;
+    x.reserve(1000);
+    for (int k = 0; k < 20; ++k) { x.push_back(k); }
+    x.shrink_to_fit();
+    EXPECT_EQ(20, x.capacity());
+    EXPECT_EQ(19, x.back());
+
+    epl::small_vector<std::string, 4> s;
+    for (int k = 0; k < 10; ++k) { s.push_back(std::to_string(k)); }
+    while (s.size() > 3) { s.pop_front(); }
+    s.shrink_to_fit(); // back into the inline buffer
+    EXPECT_EQ(4, s.capacity());
+    EXPECT_EQ("7", s.front());
+    EXPECT_EQ("9", s.back());
+}
+
+TEST(Capacity, AutoShrink) {
+    vector x;
+    x.set_auto_shrink(true);
+    for (int k = 0; k < 4096; ++k) { x.push_back(k); }
+    uint64_t peak = x.capacity();
+    while (x.size() > 10) { x.pop_back(); }
+
+    EXPECT_GT(peak / 8, x.capacity());
+    EXPECT_LE(10, x.capacity());
+    for (int k = 0; k < 10; ++k) { EXPECT_EQ(k, x[k]); }
+}
@@ -0,0 +1,168 @@
+/*
+ * Vector_ChunkedVector_unittests.cpp
+ *
+ * Tests for epl::chunked_vector: both ends across block boundaries, element
+ * stability, exception safety and the iterator invalidation rules.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <stdexcept>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "ChunkedVector.h"
+
+using epl::chunked_vector;
+
+namespace {
+    struct Throwing {
+        static int live;
+        int value;
+
+        Throwing(int value) : value(value) {
+            if (value < 0) { throw std::runtime_error("negative"); }
+            ++live;
+        }
+        Throwing(const Throwing& that) : value(that.value) { ++live; }
+        ~Throwing(void) { --live; }
+    };
+    int Throwing::live = 0;
+} //namespace
+
+TEST(ChunkedVector, MatchesDeque) {
+    chunked_vector<int> x;
+    std::deque<int> d;
+    for (int k = 0; k < 20000; ++k) {
+        switch ((k * 7) % 5) {
+            case 0: case 1: x.push_back(k); d.push_back(k); break;
+            case 2: case 3: x.push_front(k); d.push_front(k); break;
+            default:
+                if (k % 2) { x.pop_back(); d.pop_back(); } else { x.pop_front(); d.pop_front(); }
+        }
+        ASSERT_EQ(d.size(), x.size());
+    }
+    for (uint64_t k = 0; k < d.size(); ++k) { ASSERT_EQ(d[k], x[k]); }
+    EXPECT_EQ(d.front(), x.front());
+    EXPECT_EQ(d.back(), x.back());
+    EXPECT_THROW(x[x.size()], std::out_of_range);
+
+    while (x.size() != 0) { x.pop_back(); }
+    EXPECT_THROW(x.pop_front(), std::out_of_range);
+    EXPECT_THROW(x.back(), std::out_of_range);
+    x.push_front(1);
+    x.push_back(2);
+    EXPECT_EQ(1, x[0]);
+    EXPECT_EQ(2, x[1]);
+}
+
+TEST(ChunkedVector, ElementsNeverMove) {
+    chunked_vector<std::string> x;
+    x.push_back("middle");
+    const std::string* middle = &x[0];
+    for (int k = 0; k < 5000; ++k) {
+        x.push_back(std::to_string(k));
+        x.push_front(std::to_string(-k));
+    }
+    EXPECT_EQ(middle, &x[5000]);
+    EXPECT_EQ("middle", *middle);
+    EXPECT_EQ("-4999", x.front());
+    EXPECT_EQ("4999", x.back());
+}
+
+TEST(ChunkedVector, CopyMoveAssign) {
+    chunked_vector<std::string> x = { "a", "b", "c" };
+    x.push_front("z");
+    chunked_vector<std::string> y(x);
+    EXPECT_EQ(4, y.size());
+    EXPECT_EQ("z", y[0]);
+
+    chunked_vector<std::string> z(std::move(x));
+    EXPECT_EQ(0, x.size());
+    EXPECT_EQ("c", z.back());
+    x.push_back("again");
+    EXPECT_EQ("again", x[0]);
+
+    y = z;
+    y.push_back("d");
+    EXPECT_EQ(4, z.size());
+    z = std::move(y);
+    EXPECT_EQ(5, z.size());
+    EXPECT_EQ("d", z.back());
+    EXPECT_TRUE(std::equal(z.begin(), z.end(), chunked_vector<std::string>({ "z", "a", "b", "c", "d" }).begin()));
+}
+
+TEST(ChunkedVector, ExceptionSafety) {
+    {
+        chunked_vector<Throwing> x;
+        const uint64_t n = chunked_vector<Throwing>::block_size;
+        for (uint64_t k = 0; k < n; ++k) { x.emplace_back((int) k); }
+        EXPECT_THROW(x.emplace_back(-1), std::runtime_error); // would start a new block
+        EXPECT_THROW(x.emplace_front(-1), std::runtime_error);
+        EXPECT_EQ(n, x.size());
+        x.emplace_front(7);
+        x.emplace_back(8);
+        EXPECT_EQ(7, x.front().value);
+        EXPECT_EQ(8, x.back().value);
+        EXPECT_EQ(n + 2, (uint64_t) Throwing::live);
+    }
+    EXPECT_EQ(0, Throwing::live);
+}
+
+TEST(ChunkedVector, IteratorsSurviveGrowth) {
+    chunked_vector<int, epl::checked> x;
+    for (int k = 0; k < 1000; ++k) { x.push_back(k); }
+
+    auto it = x.begin() + 500;
+    auto first = x.begin();
+    for (int k = 0; k < 3000; ++k) {
+        x.push_back(k);
+        x.push_front(-k);
+    }
+    EXPECT_EQ(500, *it); // same element, even though its index moved
+    EXPECT_EQ(0, *first);
+    EXPECT_EQ(3500, it - x.begin());
+    EXPECT_EQ(7000, x.end() - x.begin());
+    EXPECT_EQ(x.end(), std::find(x.begin(), x.end(), 123456));
+
+    x.pop_back();
+    EXPECT_THROW(*it, epl::invalid_iterator);
+
+    auto last = x.end() - 1;
+    x.pop_back();
+    try {
+        *last;
+        FAIL();
+    } catch (const epl::invalid_iterator& e) {
+        EXPECT_EQ(epl::invalid_iterator::SEVERE, e.level);
+    }
+
+    chunked_vector<int, epl::checked> y(30);
+    auto mid = y.begin() + 10;
+    y = chunked_vector<int, epl::checked>(20);
+    try {
+        *mid;
+        FAIL();
+    } catch (const epl::invalid_iterator& e) {
+        EXPECT_EQ(epl::invalid_iterator::MODERATE, e.level);
+    }
+}
+
+TEST(ChunkedVector, SortAndConstIteration) {
+    chunked_vector<int64_t, epl::checked> x;
+    for (int64_t k = 0; k < 10000; ++k) {
+        if (k % 2) { x.push_front((k * 7919) % 10000); } else { x.push_back((k * 7919) % 10000); }
+    }
+    std::sort(x.begin(), x.end());
+    const chunked_vector<int64_t, epl::checked>& c = x;
+    int64_t expect = 0;
+    for (auto it = c.begin(); it != c.end(); ++it) { ASSERT_EQ(expect++, *it); }
+    chunked_vector<int64_t, epl::checked>::const_iterator ci = x.begin();
+    EXPECT_TRUE(ci == c.cbegin());
+}
+
+TEST(ChunkedVector, UncheckedKeepsNoVersions) {
+    EXPECT_EQ(sizeof(chunked_vector<int, epl::checked>) - 2 * sizeof(size_t), sizeof(chunked_vector<int, epl::unchecked>));
+    EXPECT_EQ(sizeof(chunked_vector<int, epl::checked>::iterator) - 2 * sizeof(size_t), sizeof(chunked_vector<int, epl::unchecked>::iterator));
+}
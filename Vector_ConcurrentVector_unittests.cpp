@@ -0,0 +1,173 @@
+/*
+ * Vector_ConcurrentVector_unittests.cpp
+ *
+ * Tests for epl::concurrent_vector: bucket layout, reference stability,
+ * iterators, failed constructors and concurrent pushes with readers.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "ConcurrentVector.h"
+
+using epl::concurrent_vector;
+
+namespace {
+    struct Fragile {
+        static int live;
+        int value;
+
+        Fragile(int value) : value(value) {
+            if (value < 0) { throw std::runtime_error("negative"); }
+            ++live;
+        }
+        Fragile(const Fragile& that) : value(that.value) { ++live; }
+        ~Fragile(void) { --live; }
+    };
+    int Fragile::live = 0;
+
+    // throws bad_alloc from the next allocate() once fail_next is set
+    template <typename T>
+    struct FailingAllocator : std::allocator<T> {
+        static bool fail_next;
+
+        template <typename U> struct rebind { typedef FailingAllocator<U> other; };
+
+        FailingAllocator(void) {}
+        template <typename U>
+        FailingAllocator(const FailingAllocator<U>&) {}
+
+        T* allocate(size_t n) {
+            if (fail_next) {
+                fail_next = false;
+                throw std::bad_alloc();
+            }
+            return std::allocator<T>::allocate(n);
+        }
+    };
+    template <typename T> bool FailingAllocator<T>::fail_next = false;
+} //namespace
+
+TEST(ConcurrentVector, StableReferences) {
+    concurrent_vector<std::string> x;
+    EXPECT_TRUE(x.empty());
+    EXPECT_EQ(0, x.capacity());
+
+    EXPECT_EQ(0, x.push_back("zero"));
+    const std::string* first = &x[0];
+    for (int k = 1; k < 10000; ++k) {
+        EXPECT_EQ(k, x.emplace_back(std::to_string(k)));
+    }
+    EXPECT_EQ(first, &x[0]);
+    EXPECT_EQ("zero", *first);
+    EXPECT_EQ(10000, x.size());
+    EXPECT_GE(x.capacity(), 10000);
+    EXPECT_LT(x.capacity(), 2 * 10000 + 8);
+    EXPECT_EQ("9999", x.at(9999));
+    EXPECT_THROW(x.at(10000), std::out_of_range);
+
+    x.clear();
+    EXPECT_EQ(0, x.size());
+    EXPECT_GE(x.capacity(), 10000);
+    x.push_back("again");
+    EXPECT_EQ(first, &x[0]);
+}
+
+TEST(ConcurrentVector, Iterators) {
+    concurrent_vector<int> x;
+    x.reserve(100);
+    const uint64_t cap = x.capacity();
+    EXPECT_GE(cap, 100);
+    for (int k = 0; k < 100; ++k) { x.push_back(99 - k); }
+    EXPECT_EQ(cap, x.capacity());
+
+    auto first = x.begin();
+    auto last = x.end();
+    EXPECT_EQ(100, last - first);
+    EXPECT_EQ(99, *first);
+    EXPECT_EQ(0, first[99]);
+    EXPECT_EQ(49, *(first + 50));
+    EXPECT_TRUE(first < last);
+
+    x.push_back(-1);
+    EXPECT_EQ(100, last - first); // an earlier end() does not move
+    EXPECT_EQ(99, *first);
+
+    std::sort(x.begin(), x.end());
+    EXPECT_TRUE(std::is_sorted(x.begin(), x.end()));
+    EXPECT_EQ(-1, x[0]);
+
+    const concurrent_vector<int>& c = x;
+    concurrent_vector<int>::const_iterator it = x.begin();
+    EXPECT_TRUE(it == c.begin());
+    EXPECT_EQ(101, std::count_if(c.cbegin(), c.cend(), [](int v) { return v < 100; }));
+}
+
+TEST(ConcurrentVector, FailedConstruction) {
+    {
+        concurrent_vector<Fragile> x;
+        x.emplace_back(1);
+        EXPECT_THROW(x.emplace_back(-1), std::runtime_error);
+        x.emplace_back(3);
+        EXPECT_EQ(3, x.size());
+        EXPECT_EQ(3, x.at(2).value);
+        EXPECT_THROW(x.at(1), std::out_of_range);
+        EXPECT_EQ(2, Fragile::live);
+    }
+    EXPECT_EQ(0, Fragile::live);
+}
+
+TEST(ConcurrentVector, FailedBucketAllocation) {
+    concurrent_vector<int, FailingAllocator<int>> x;
+    for (int k = 0; k < 8; ++k) { x.push_back(k); } // fills the first bucket
+    FailingAllocator<int>::fail_next = true;
+    EXPECT_THROW(x.push_back(8), std::bad_alloc);
+    EXPECT_EQ(8, x.size());
+    x.push_back(9);
+    x.push_back(10);
+    EXPECT_EQ(10, x.size()); // later pushes are not stuck behind the failure
+    EXPECT_EQ(9, x[8]);
+    EXPECT_EQ(10, x.at(9));
+}
+
+TEST(ConcurrentVector, ConcurrentPushAndRead) {
+    const int threads = 8;
+    const int each = 50000;
+    concurrent_vector<uint64_t> x;
+    std::atomic<bool> done(false);
+    std::atomic<uint64_t> bad(0);
+
+    std::thread reader([&] {
+        while (! done) {
+            const uint64_t n = x.size();
+            for (uint64_t k = n > 64 ? n - 64 : 0; k < n; ++k) {
+                if (x[k] >= (uint64_t) threads * each) { ++bad; }
+            }
+        }
+    });
+    std::vector<std::thread> writers;
+    for (int t = 0; t < threads; ++t) {
+        writers.emplace_back([&x, t] {
+            for (int k = 0; k < each; ++k) {
+                x.push_back((uint64_t) k * threads + t);
+            }
+        });
+    }
+    for (std::thread& w : writers) { w.join(); }
+    done = true;
+    reader.join();
+
+    ASSERT_EQ((uint64_t) threads * each, x.size());
+    EXPECT_EQ(0, bad);
+    std::vector<uint64_t> all(x.begin(), x.end());
+    std::sort(all.begin(), all.end());
+    for (uint64_t k = 0; k < all.size(); ++k) { ASSERT_EQ(k, all[k]); }
+}
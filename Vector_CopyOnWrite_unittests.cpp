@@ -0,0 +1,170 @@
+/*
+ * Vector_CopyOnWrite_unittests.cpp
+ *
+ * Tests for copy-on-write vectors: copies share one buffer, the first write
+ * detaches, outstanding iterators are invalidated, and a vector that handed
+ * out a mutable reference is never shared.
+ */
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "Vector.h"
+
+using epl::vector;
+
+namespace {
+    struct Counted {
+        static uint64_t copies;
+        int value;
+
+        Counted(int value) : value(value) {}
+        Counted(const Counted& that) : value(that.value) { ++copies; }
+        Counted(Counted&& that) noexcept : value(that.value) {}
+    };
+    uint64_t Counted::copies = 0;
+
+    struct ThrowsOnCopy {
+        static int copies_left;
+        int value;
+
+        ThrowsOnCopy(int value) : value(value) {}
+        ThrowsOnCopy(const ThrowsOnCopy& that) : value(that.value) {
+            if (copies_left-- == 0) { throw std::runtime_error("copy"); }
+        }
+        ThrowsOnCopy(ThrowsOnCopy&& that) noexcept : value(that.value) {}
+    };
+    int ThrowsOnCopy::copies_left = 0;
+} //namespace
+
+TEST(CopyOnWrite, CopiesShareUntilWritten) {
+    vector<Counted> x;
+    x.set_copy_on_write(true);
+    for (int k = 0; k < 100; ++k) { x.emplace_back(k); }
+    EXPECT_FALSE(x.is_shared());
+
+    Counted::copies = 0;
+    vector<Counted> y(x);
+    vector<Counted> z;
+    z = y;
+    EXPECT_EQ(0, Counted::copies);
+    EXPECT_TRUE(x.is_shared());
+    const vector<Counted>& cx = x;
+    const vector<Counted>& cy = y;
+    EXPECT_EQ(cx.data(), cy.data());
+    EXPECT_EQ(99, cy[99].value);
+
+    y.push_back(Counted(100)); // detaches y only
+    EXPECT_EQ(100, Counted::copies);
+    EXPECT_NE(cx.data(), cy.data());
+    EXPECT_EQ(101, y.size());
+    EXPECT_EQ(100, x.size());
+    EXPECT_TRUE(x.is_shared()); // still with z
+    EXPECT_FALSE(y.is_shared());
+
+    z[0].value = -1;
+    EXPECT_EQ(200, Counted::copies);
+    EXPECT_EQ(0, cx[0].value);
+    EXPECT_FALSE(x.is_shared());
+
+    x.pop_front(); // the last owner writes in place
+    EXPECT_EQ(200, Counted::copies);
+    EXPECT_EQ(1, cx[0].value);
+}
+
+TEST(CopyOnWrite, ThrowingAssignmentLeavesEmpty) {
+    vector<ThrowsOnCopy> x;
+    x.set_copy_on_write(true);
+    for (int k = 0; k < 10; ++k) { x.emplace_back(k); }
+    vector<ThrowsOnCopy> y(x);
+    EXPECT_TRUE(y.is_shared());
+
+    vector<ThrowsOnCopy> source;
+    for (int k = 0; k < 10; ++k) { source.emplace_back(-k); }
+    ThrowsOnCopy::copies_left = 3;
+    EXPECT_THROW(y = source, std::runtime_error);
+    EXPECT_EQ(0, y.size());
+    EXPECT_FALSE(x.is_shared()); // y let go of the buffer exactly once
+    const vector<ThrowsOnCopy>& cx = x;
+    EXPECT_EQ(9, cx[9].value);
+
+    y.emplace_back(1);
+    EXPECT_EQ(1, y.size());
+}
+
+TEST(CopyOnWrite, OffByDefault) {
+    vector<std::string> x{ "a", "b" };
+    vector<std::string> y(x);
+    EXPECT_FALSE(x.is_shared());
+    const vector<std::string>& cx = x;
+    const vector<std::string>& cy = y;
+    EXPECT_NE(cx.data(), cy.data());
+
+    x.set_copy_on_write(true);
+    vector<std::string> z(x);
+    EXPECT_TRUE(z.is_shared());
+    x.set_copy_on_write(false); // detaches x
+    EXPECT_FALSE(z.is_shared());
+    x.push_back("c");
+    EXPECT_EQ(2, z.size());
+}
+
+TEST(CopyOnWrite, MutableReferencesAreNotShared) {
+    vector<int> x{ 1, 2, 3 };
+    x.set_copy_on_write(true);
+    int& first = x[0];
+    vector<int> y(x);
+    EXPECT_FALSE(x.is_shared());
+    first = 10;
+    EXPECT_EQ(1, y[0]);
+
+    // a reallocation ends the reference's life, so sharing resumes
+    for (int k = 0; k < 20; ++k) { x.push_back(k); }
+    vector<int> z(x);
+    EXPECT_TRUE(x.is_shared());
+    EXPECT_EQ(10, z[0]);
+}
+
+TEST(CopyOnWrite, DetachInvalidatesIterators) {
+    if (! epl::default_checking::enabled) { return; }
+    vector<int> x{ 1, 2, 3 };
+    x.set_copy_on_write(true);
+    vector<int> y(x);
+
+    const vector<int>& cx = x;
+    vector<int>::const_iterator it = cx.begin();
+    EXPECT_EQ(1, *it);
+    x.begin(); // detaches
+    try {
+        (void) *it;
+        FAIL();
+    } catch (epl::invalid_iterator& e) {
+        EXPECT_EQ(epl::invalid_iterator::MODERATE, e.level);
+    }
+
+    vector<int>::const_iterator yt = static_cast<const vector<int>&>(y).begin();
+    EXPECT_EQ(3, *(yt + 2)); // y owns the old buffer alone and was never written
+}
+
+TEST(CopyOnWrite, ReadersInThreads) {
+    vector<uint64_t> x;
+    x.set_copy_on_write(true);
+    for (uint64_t k = 0; k < 10000; ++k) { x.push_back(k); }
+
+    std::vector<uint64_t> sums(8);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 8; ++t) {
+        readers.emplace_back([&sums, t](vector<uint64_t> copy) {
+            const vector<uint64_t>& c = copy;
+            for (uint64_t v : c) { sums[t] += v; }
+            if (t % 2 == 0) { copy.push_back(0); } // some readers detach
+        }, x);
+    }
+    for (std::thread& r : readers) { r.join(); }
+    for (uint64_t s : sums) { EXPECT_EQ(10000ull * 9999 / 2, s); }
+    EXPECT_FALSE(x.is_shared());
+}
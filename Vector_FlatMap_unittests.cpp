@@ -0,0 +1,127 @@
+/*
+ * Vector_FlatMap_unittests.cpp
+ *
+ * Tests for epl::flat_set and epl::flat_map: lookup, single inserts at both
+ * ends, batched insert_range against std::set/std::map, erase and the map
+ * accessors.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "FlatMap.h"
+
+using epl::flat_map;
+using epl::flat_set;
+
+TEST(FlatSet, InsertAndLookup) {
+    flat_set<int> s{ 5, 1, 3, 3, 9 };
+    EXPECT_EQ(4, s.size());
+    EXPECT_EQ((std::vector<int>{ 1, 3, 5, 9 }), std::vector<int>(s.begin(), s.end()));
+
+    EXPECT_TRUE(s.contains(3));
+    EXPECT_FALSE(s.contains(4));
+    EXPECT_EQ(1, s.count(9));
+    EXPECT_TRUE(s.find(4) == s.end());
+    EXPECT_EQ(5, *s.lower_bound(4));
+    EXPECT_EQ(5, *s.upper_bound(3));
+    auto range = s.equal_range(3);
+    EXPECT_EQ(1, range.second - range.first);
+
+    auto result = s.insert(4);
+    EXPECT_TRUE(result.second);
+    EXPECT_EQ(4, *result.first);
+    result = s.insert(4);
+    EXPECT_FALSE(result.second);
+    EXPECT_EQ(2, result.first - s.begin());
+
+    EXPECT_EQ(1, s.erase(1));
+    EXPECT_EQ(0, s.erase(1));
+    auto it = s.erase(s.find(5));
+    EXPECT_EQ(9, *it);
+    EXPECT_EQ((std::vector<int>{ 3, 4, 9 }), std::vector<int>(s.begin(), s.end()));
+}
+
+TEST(FlatSet, FrontInsertsShiftTheFront) {
+    flat_set<int> s;
+    for (int k = 0; k < 1000; ++k) { s.insert(1000 - k); } // each insert is at the front
+    EXPECT_EQ(1000, s.size());
+    EXPECT_EQ(1, *s.begin());
+    EXPECT_EQ(1000, *(s.end() - 1));
+
+    // a front insert leaves the back of the buffer where it was
+    s.reserve(2000);
+    const int* last = &*(s.end() - 1);
+    s.insert(0);
+    EXPECT_EQ(last, &*(s.end() - 1));
+}
+
+TEST(FlatSet, InsertRangeMatchesStdSet) {
+    std::mt19937 rng(7);
+    flat_set<uint32_t> s;
+    std::set<uint32_t> model;
+    for (int batch = 0; batch < 20; ++batch) {
+        std::vector<uint32_t> keys;
+        for (int k = 0; k < 500; ++k) { keys.push_back(rng() % 5000); }
+        s.insert_range(keys.begin(), keys.end());
+        model.insert(keys.begin(), keys.end());
+        ASSERT_EQ(model.size(), s.size());
+    }
+    EXPECT_TRUE(std::equal(model.begin(), model.end(), s.begin()));
+
+    std::vector<uint32_t> none;
+    s.insert_range(none.begin(), none.end());
+    EXPECT_EQ(model.size(), s.size());
+}
+
+TEST(FlatMap, Accessors) {
+    flat_map<std::string, int> m{ { "b", 2 }, { "a", 1 } };
+    EXPECT_EQ("a", m.begin()->first);
+    EXPECT_EQ(2, m.at("b"));
+    EXPECT_THROW(m.at("z"), std::out_of_range);
+
+    m["c"] = 3;
+    m["a"] += 10;
+    EXPECT_EQ(3, m.size());
+    EXPECT_EQ(11, m.at("a"));
+
+    EXPECT_FALSE(m.try_emplace("b", 20).second);
+    EXPECT_EQ(2, m["b"]);
+    EXPECT_TRUE(m.emplace("d", 4).second);
+    m.find("d")->second = 40;
+
+    const flat_map<std::string, int>& c = m;
+    EXPECT_EQ(40, c.at("d"));
+    EXPECT_TRUE(c.find("e") == c.end());
+}
+
+TEST(FlatMap, InsertRangeKeepsFirstValue) {
+    std::vector<std::pair<int, std::string>> batch{ { 3, "three" }, { 1, "one" }, { 3, "drei" }, { 2, "two" } };
+    flat_map<int, std::string> m{ { 2, "zwei" } };
+    m.insert_range(batch.begin(), batch.end());
+
+    std::map<int, std::string> model{ { 2, "zwei" } };
+    model.insert(batch.begin(), batch.end());
+    EXPECT_EQ(model.size(), m.size());
+    EXPECT_TRUE(std::equal(model.begin(), model.end(), m.begin(), [](const std::pair<const int, std::string>& a, const std::pair<int, std::string>& b) {
+        return a.first == b.first && a.second == b.second;
+    }));
+    EXPECT_EQ("three", m.at(3));
+    EXPECT_EQ("zwei", m.at(2));
+}
+
+TEST(FlatMap, IteratorsInvalidated) {
+    if (! epl::default_checking::enabled) { return; }
+    flat_map<int, int> m{ { 1, 1 }, { 2, 2 } };
+    auto it = m.find(2);
+    m[3] = 3;
+    EXPECT_THROW((void) it->second, epl::invalid_iterator);
+}
@@ -0,0 +1,114 @@
+/*
+ * Vector_Growth_unittests.cpp
+ *
+ * Tests for vector growth policies: growth factors, the minimum capacity,
+ * size-class rounding and the adaptive split of free room between the ends.
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "gtest/gtest.h"
+#include "Allocators.h"
+#include "Vector.h"
+
+using epl::vector;
+
+namespace {
+    template <typename V>
+    std::vector<uint64_t> capacities(V& x, int pushes) {
+        std::vector<uint64_t> seen{ x.capacity() };
+        for (int k = 0; k < pushes; ++k) {
+            x.push_back(k);
+            if (x.capacity() != seen.back()) { seen.push_back(x.capacity()); }
+        }
+        return seen;
+    }
+
+    struct tiny_growth : epl::factor_growth<2, 1, 2> {};
+} //namespace
+
+TEST(Growth, DefaultDoubles) {
+    vector<int> x;
+    std::vector<uint64_t> expected{ 8, 16, 32, 64, 128, 256 };
+    EXPECT_EQ(expected, capacities(x, 100));
+}
+
+TEST(Growth, OneAndAHalf) {
+    vector<int, epl::default_checking, std::allocator<int>, 0, epl::one_and_half_growth> x;
+    std::vector<uint64_t> expected{ 8, 12, 18, 27, 40, 60, 90, 135 };
+    EXPECT_EQ(expected, capacities(x, 100));
+    for (int k = 0; k < 100; ++k) { EXPECT_EQ(k, x[k]); }
+
+    // the factor also applies to growth at the front
+    vector<int, epl::default_checking, std::allocator<int>, 0, epl::one_and_half_growth> y(12);
+    for (int k = 0; k < 10; ++k) { y.push_front(k); }
+    EXPECT_EQ(40, y.capacity());
+    EXPECT_EQ(9, y.front());
+}
+
+TEST(Growth, MinimumCapacity) {
+    vector<int, epl::default_checking, std::allocator<int>, 0, tiny_growth> x;
+    std::vector<uint64_t> expected{ 2, 4, 8, 16 };
+    EXPECT_EQ(expected, capacities(x, 10));
+
+    x.resize(1);
+    x.shrink_to_fit();
+    EXPECT_EQ(2, x.capacity());
+}
+
+TEST(Growth, SizeClasses) {
+    vector<std::string, epl::default_checking, std::allocator<std::string>, 0, epl::size_class_growth<>> x;
+    for (int k = 0; k < 1000; ++k) {
+        x.push_back(std::to_string(k));
+        EXPECT_LE(x.size(), x.capacity());
+    }
+    for (int k = 0; k < 1000; ++k) { EXPECT_EQ(std::to_string(k), x[k]); }
+
+    // each growth gets at least what the plain policy asks for, rounded up
+    // to a whole malloc size class
+    vector<char, epl::unchecked, std::allocator<char>, 0, epl::size_class_growth<>> c;
+    uint64_t old_capacity = c.capacity();
+    for (int k = 0; k < 5000; ++k) {
+        c.push_back('a');
+        if (c.capacity() == old_capacity) { continue; }
+        EXPECT_GE(c.capacity(), epl::double_growth().grow(old_capacity, old_capacity + 1, 1));
+#ifdef __GLIBC__
+        void* probe = std::malloc(c.capacity());
+        EXPECT_EQ(c.capacity(), malloc_usable_size(probe));
+        std::free(probe);
+#endif
+        old_capacity = c.capacity();
+    }
+
+    static_assert(! epl::detail::growth_supports_allocator<epl::size_class_growth<>, epl::arena_allocator<char>>::value,
+                  "size classes only describe malloc");
+}
+
+TEST(Growth, AdaptiveSplit) {
+    // appending only: the room kept at the front dies away
+    vector<int, epl::unchecked, std::allocator<int>, 0, epl::adaptive_split<>> appended;
+    vector<int, epl::unchecked> plain;
+    for (int k = 0; k < 100000; ++k) {
+        appended.push_back(k);
+        plain.push_back(k);
+    }
+    EXPECT_LT(appended.capacity(), plain.capacity());
+    for (int k = 0; k < 100000; ++k) { EXPECT_EQ(k, appended[k]); }
+
+    // used as a deque: both ends keep getting room
+    vector<int, epl::unchecked, std::allocator<int>, 0, epl::adaptive_split<>> both;
+    for (int k = 0; k < 10000; ++k) {
+        both.push_back(k);
+        both.push_front(-k);
+    }
+    EXPECT_EQ(20000, both.size());
+    EXPECT_EQ(-9999, both.front());
+    EXPECT_EQ(9999, both.back());
+    EXPECT_LE(both.capacity(), 4 * both.size());
+}
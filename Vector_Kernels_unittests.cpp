@@ -0,0 +1,96 @@
+/*
+ * Vector_Kernels_unittests.cpp
+ *
+ * Tests for the numeric kernels in Kernels.h, checked against plain loops at
+ * sizes around the SIMD block boundaries.
+ */
+
+#include <cmath>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "Kernels.h"
+
+using epl::vector;
+
+namespace {
+    template <typename T>
+    vector<T> ramp(uint64_t n, int64_t offset) {
+        vector<T> x;
+        for (uint64_t k = 0; k < n; ++k) {
+            x.push_back((T) ((int64_t) ((k * 37) % 101) - offset));
+        }
+        return x;
+    }
+} //namespace
+
+template <typename T>
+class Kernels : public ::testing::Test {};
+
+typedef ::testing::Types<int32_t, int64_t, float, double> Arithmetic;
+TYPED_TEST_SUITE(Kernels, Arithmetic);
+
+TYPED_TEST(Kernels, Reductions) {
+    for (uint64_t n : { 1, 7, 16, 63, 64, 65, 1000 }) {
+        vector<TypeParam> x = ramp<TypeParam>(n, 50);
+        vector<TypeParam> y = ramp<TypeParam>(n, 20);
+
+        TypeParam s = 0, d = 0, lo = x[0], hi = x[0];
+        uint64_t lo_at = 0, hi_at = 0;
+        for (uint64_t k = 0; k < n; ++k) {
+            s += x[k];
+            d += x[k] * y[k];
+            if (x[k] < lo) { lo = x[k]; lo_at = k; }
+            if (x[k] > hi) { hi = x[k]; hi_at = k; }
+        }
+
+        EXPECT_EQ(s, epl::sum(x)) << n;
+        EXPECT_EQ(d, epl::dot(x, y)) << n;
+        EXPECT_EQ(lo, epl::min_value(x)) << n;
+        EXPECT_EQ(hi, epl::max_value(x)) << n;
+        EXPECT_EQ(lo_at, epl::argmin(x)) << n;
+        EXPECT_EQ(hi_at, epl::argmax(x)) << n;
+    }
+    EXPECT_THROW(epl::min_value(vector<TypeParam>()), std::out_of_range);
+}
+
+TYPED_TEST(Kernels, SearchAndCount) {
+    vector<TypeParam> x = ramp<TypeParam>(1000, 0);
+    EXPECT_EQ(0, epl::find(x, (TypeParam) 0));
+    EXPECT_EQ(1, epl::find(x, (TypeParam) 37));
+    EXPECT_EQ(x.size(), epl::find(x, (TypeParam) 500));
+
+    uint64_t c = 0;
+    for (uint64_t k = 0; k < x.size(); ++k) { c += (x[k] == 3); }
+    EXPECT_EQ(c, epl::count(x, (TypeParam) 3));
+}
+
+TYPED_TEST(Kernels, Elementwise) {
+    vector<TypeParam> x = ramp<TypeParam>(100, 50);
+    vector<TypeParam> y(100);
+    epl::fill(y, (TypeParam) 2);
+    EXPECT_EQ(200, epl::sum(y));
+
+    epl::axpy((TypeParam) 3, x, y);
+    for (uint64_t k = 0; k < 100; ++k) {
+        EXPECT_EQ(2 + 3 * x[k], y[k]);
+    }
+
+    // in place: y[k] += 2 * y[k]
+    vector<TypeParam> z = y;
+    epl::axpy((TypeParam) 2, z, z);
+    for (uint64_t k = 0; k < 100; ++k) {
+        EXPECT_EQ(y[k] + 2 * y[k], z[k]);
+    }
+
+    vector<uint8_t> mask;
+    epl::less(x, y, mask);
+    ASSERT_EQ(100, mask.size());
+    for (uint64_t k = 0; k < 100; ++k) {
+        EXPECT_EQ(x[k] < y[k], mask[k] != 0);
+    }
+
+    EXPECT_TRUE(epl::equal(x, ramp<TypeParam>(100, 50)));
+    EXPECT_FALSE(epl::equal(x, y));
+    EXPECT_THROW(epl::dot(x, vector<TypeParam>(3)), std::invalid_argument);
+}
@@ -0,0 +1,143 @@
+/*
+ * Vector_Parallel_unittests.cpp
+ *
+ * Tests for the thread pool and the parallel algorithms in Parallel.h, over
+ * ranges large enough to be split into many chunks.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <stdexcept>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "ChunkedVector.h"
+#include "Parallel.h"
+#include "Vector.h"
+
+using epl::vector;
+
+namespace {
+    // unaligned data_start: the vector has front room after push_front
+    vector<int64_t> shuffled(uint64_t n) {
+        vector<int64_t> x;
+        for (uint64_t k = 0; k < n; ++k) {
+            int64_t v = (int64_t) ((k * 7919) % n);
+            if (k % 2) { x.push_front(v); } else { x.push_back(v); }
+        }
+        return x;
+    }
+} //namespace
+
+TEST(ThreadPool, RunsEveryTask) {
+    epl::thread_pool pool(4);
+    EXPECT_EQ(4, pool.size());
+    std::atomic<int> done(0);
+    {
+        epl::task_group group(pool);
+        for (int k = 0; k < 1000; ++k) {
+            group.run([&done] { ++done; });
+        }
+        group.wait();
+    }
+    EXPECT_EQ(1000, done);
+}
+
+TEST(ThreadPool, NestedGroupsAndExceptions) {
+    epl::thread_pool pool(3);
+    std::atomic<int> done(0);
+    epl::task_group outer(pool);
+    for (int k = 0; k < 8; ++k) {
+        outer.run([&pool, &done] {
+            epl::task_group inner(pool);
+            for (int j = 0; j < 8; ++j) { inner.run([&done] { ++done; }); }
+            inner.wait();
+        });
+    }
+    outer.wait();
+    EXPECT_EQ(64, done);
+
+    epl::task_group failing(pool);
+    failing.run([] { throw std::runtime_error("task failed"); });
+    failing.run([&done] { ++done; });
+    EXPECT_THROW(failing.wait(), std::runtime_error);
+    EXPECT_EQ(65, done);
+}
+
+TEST(Parallel, ContiguousIteratorsOnly) {
+    EXPECT_TRUE(epl::detail::is_contiguous_iterator<int*>::value);
+    EXPECT_TRUE(epl::detail::is_contiguous_iterator<const int*>::value);
+    EXPECT_TRUE((epl::detail::is_contiguous_iterator<vector<int, epl::checked>::iterator>::value));
+    EXPECT_TRUE((epl::detail::is_contiguous_iterator<vector<int, epl::checked>::const_iterator>::value));
+    EXPECT_FALSE(epl::detail::is_contiguous_iterator<std::deque<int>::iterator>::value);
+    EXPECT_FALSE(epl::detail::is_contiguous_iterator<epl::chunked_vector<int>::iterator>::value);
+}
+
+TEST(Parallel, ForEachTransformReduce) {
+    for (uint64_t threads : { 1, 2, 5 }) {
+        epl::thread_pool pool(threads);
+        vector<int64_t> x = shuffled(200001);
+
+        epl::parallel::for_each(pool, x.begin(), x.end(), [](int64_t& v) { v *= 2; });
+        vector<int64_t> y(x.size());
+        epl::parallel::transform(pool, x.begin(), x.end(), y.begin(), [](int64_t v) { return v + 1; });
+
+        int64_t expect = 0;
+        for (uint64_t k = 0; k < x.size(); ++k) {
+            ASSERT_EQ(x[k] + 1, y[k]);
+            expect += y[k];
+        }
+        EXPECT_EQ(expect, epl::parallel::reduce(pool, y.begin(), y.end(), (int64_t) 0, std::plus<int64_t>()));
+        EXPECT_EQ(7, epl::parallel::reduce(pool, y.begin(), y.begin(), (int64_t) 7, std::plus<int64_t>()));
+    }
+}
+
+TEST(Parallel, ReduceKeepsChunkOrder) {
+    epl::thread_pool pool(4);
+    vector<std::string> x;
+    std::string expect;
+    for (int k = 0; k < 20000; ++k) {
+        x.push_back(std::string(1, (char) ('a' + k % 26)));
+        expect += x.back();
+    }
+    auto concat = [](std::string a, const std::string& b) { return a + b; };
+    EXPECT_EQ(expect, epl::parallel::reduce(pool, x.begin(), x.end(), std::string(), concat));
+}
+
+TEST(Parallel, Sort) {
+    for (uint64_t threads : { 1, 2, 3, 8 }) {
+        epl::thread_pool pool(threads);
+        for (uint64_t n : { 0, 1, 1000, 100000, 300007 }) {
+            vector<int64_t> x = shuffled(n);
+            epl::parallel::sort(pool, x.begin(), x.end());
+            ASSERT_TRUE(std::is_sorted(x.begin(), x.end())) << threads << " " << n;
+            for (uint64_t k = 0; k < n; ++k) { ASSERT_EQ((int64_t) k, x[k]); }
+
+            epl::parallel::sort(pool, x.begin(), x.end(), std::greater<int64_t>());
+            ASSERT_TRUE(std::is_sorted(x.begin(), x.end(), std::greater<int64_t>())) << threads << " " << n;
+        }
+    }
+
+    epl::thread_pool pool(4);
+    vector<std::string> s;
+    for (int k = 0; k < 50000; ++k) { s.push_back(std::to_string((k * 7919) % 50000)); }
+    epl::parallel::sort(pool, s.begin(), s.end());
+    EXPECT_TRUE(std::is_sorted(s.begin(), s.end()));
+}
+
+TEST(Parallel, CheckedIteratorsValidatedPerChunk) {
+    epl::thread_pool pool(2);
+    vector<int64_t, epl::checked> x;
+    for (int k = 0; k < 100000; ++k) { x.push_back(k); }
+
+    auto first = x.begin();
+    auto last = x.end();
+    epl::parallel::for_each(pool, first, last, [](int64_t& v) { ++v; });
+    EXPECT_EQ(100000, x[99999]);
+
+    x.push_back(0);
+    EXPECT_THROW(epl::parallel::for_each(pool, first, last, [](int64_t& v) { ++v; }), epl::invalid_iterator);
+    EXPECT_EQ(100000, x[99999]);
+}
@@ -0,0 +1,145 @@
+/*
+ * Vector_Persistence_unittests.cpp
+ *
+ * Tests for save/load and mapped_vector_view: round trips, and rejection of
+ * files that are corrupt, truncated or hold a different element type.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "Persistence.h"
+
+using epl::vector;
+
+namespace {
+    struct Point {
+        double x, y;
+        int32_t id;
+    };
+
+    std::string temp_path(const char* name) {
+        return ::testing::TempDir() + "epl_" + name + ".bin";
+    }
+
+    vector<Point> points(uint64_t n) {
+        vector<Point> v;
+        for (uint64_t k = 0; k < n; ++k) {
+            Point p = { k * 0.5, k * -1.5, (int32_t) k };
+            if (k % 3 == 0) { v.push_front(p); } else { v.push_back(p); }
+        }
+        return v;
+    }
+
+    template <typename T>
+    void open_view(const std::string& path, bool verify = false) {
+        epl::mapped_vector_view<T> view(path, verify);
+    }
+
+    // keeps the first n bytes of the file
+    void truncate(const std::string& path, long n) {
+        std::FILE* f = std::fopen(path.c_str(), "rb");
+        ASSERT_NE(nullptr, f);
+        std::string bytes(n, '\0');
+        ASSERT_EQ((size_t) n, std::fread(&bytes[0], 1, n, f));
+        std::fclose(f);
+        f = std::fopen(path.c_str(), "wb");
+        std::fwrite(bytes.data(), 1, n, f);
+        std::fclose(f);
+    }
+
+    // overwrites one byte of the file at offset
+    void poke(const std::string& path, long offset, unsigned char value) {
+        std::FILE* f = std::fopen(path.c_str(), "r+b");
+        ASSERT_NE(nullptr, f);
+        std::fseek(f, offset, SEEK_SET);
+        std::fputc(value, f);
+        std::fclose(f);
+    }
+} //namespace
+
+TEST(Persistence, SaveAndLoad) {
+    const std::string path = temp_path("roundtrip");
+    vector<Point> v = points(100003);
+    epl::save(v, path);
+
+    vector<Point> w;
+    w.push_back(Point());
+    epl::load(w, path);
+    ASSERT_EQ(v.size(), w.size());
+    for (uint64_t k = 0; k < v.size(); ++k) {
+        ASSERT_EQ(v[k].id, w[k].id);
+        ASSERT_EQ(v[k].y, w[k].y);
+    }
+
+    epl::save(vector<Point>(), path);
+    epl::load(w, path);
+    EXPECT_EQ(0, w.size());
+    std::remove(path.c_str());
+}
+
+TEST(Persistence, MappedView) {
+    const std::string path = temp_path("view");
+    vector<Point> v = points(5000);
+    epl::save(v, path);
+
+    epl::mapped_vector_view<Point> view(path, true);
+    ASSERT_EQ(v.size(), view.size());
+    EXPECT_EQ(v.front().id, view.front().id);
+    EXPECT_EQ(v.back().id, view.back().id);
+    EXPECT_EQ(v[1234].x, view[1234].x);
+    EXPECT_THROW(view[5000], std::out_of_range);
+    EXPECT_EQ(0, (uintptr_t) view.data() % alignof(Point));
+
+    int64_t sum = 0;
+    for (const Point& p : view) { sum += p.id; }
+    EXPECT_EQ(4999 * 5000 / 2, sum);
+
+    epl::mapped_vector_view<Point> moved(std::move(view));
+    EXPECT_EQ(0, view.size());
+    EXPECT_EQ(v[10].id, moved[10].id);
+
+    epl::save(vector<Point>(), path);
+    epl::mapped_vector_view<Point> empty(path);
+    EXPECT_EQ(0, empty.size());
+    EXPECT_EQ(empty.begin(), empty.end());
+    EXPECT_THROW(empty.front(), std::out_of_range);
+    std::remove(path.c_str());
+}
+
+TEST(Persistence, RejectsBadFiles) {
+    const std::string path = temp_path("bad");
+    vector<Point> v = points(1000);
+    vector<Point> w;
+
+    EXPECT_THROW(epl::load(w, temp_path("missing")), std::runtime_error);
+    EXPECT_THROW(open_view<Point>(temp_path("missing")), std::runtime_error);
+
+    epl::save(v, path);
+    vector<int64_t> other;
+    EXPECT_THROW(epl::load(other, path), std::runtime_error);
+    EXPECT_THROW(open_view<int64_t>(path), std::runtime_error);
+
+    poke(path, sizeof(epl::file_header) + 100, 0xFF); // payload
+    EXPECT_THROW(epl::load(w, path), std::runtime_error);
+    EXPECT_THROW(open_view<Point>(path, true), std::runtime_error);
+    EXPECT_NO_THROW(open_view<Point>(path, false));
+
+    epl::save(v, path);
+    poke(path, 8, 99); // format_version
+    EXPECT_THROW(epl::load(w, path), std::runtime_error);
+
+    epl::save(v, path);
+    poke(path, 0, 'X'); // magic
+    EXPECT_THROW(open_view<Point>(path), std::runtime_error);
+
+    epl::save(v, path);
+    truncate(path, sizeof(epl::file_header) + 10 * sizeof(Point));
+    EXPECT_THROW(epl::load(w, path), std::runtime_error);
+    EXPECT_THROW(open_view<Point>(path), std::runtime_error);
+    EXPECT_EQ(0, w.size());
+    std::remove(path.c_str());
+}
@@ -12,7 +12,11 @@
  * project will be more robust than those included in this file.
 */
 
+#include <deque>
 #include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 #include "gtest/gtest.h"
 #include "Vector.h"
 
@@ -101,3 +105,238 @@ TEST(PhaseB1, ReallocCopy)
     EXPECT_GE(2, Foo::moves);
 }
 #endif
+
+/*****************************************************************************************/
+// Minimal copies and moves
+/*****************************************************************************************/
+TEST(Temporaries, PushBuildsInPlace) {
+    Foo::reset();
+    {
+        vector<Foo> x;
+        x.reserve(4);
+        Foo f;
+        x.push_back(f);
+        EXPECT_EQ(1, Foo::copies);
+        EXPECT_EQ(0, Foo::moves);
+        x.push_back(Foo());
+        EXPECT_EQ(1, Foo::moves);
+        x.emplace_back();
+        EXPECT_EQ(1, Foo::copies);
+        EXPECT_EQ(1, Foo::moves);
+
+        x.reserve_front(8);
+        Foo::reset();
+        x.push_front(f);
+        x.push_front(Foo());
+        x.emplace_front();
+        EXPECT_EQ(1, Foo::copies);
+        EXPECT_EQ(1, Foo::moves);
+    }
+}
+
+TEST(Temporaries, GrowthMovesEachElementOnce) {
+    Foo::reset();
+    {
+        vector<Foo> x; // 8 slots
+        for (int k = 0; k < 8; ++k) { x.emplace_back(); }
+        Foo::reset();
+        x.push_back(Foo()); // relocates the 8 and moves the new one in
+        EXPECT_EQ(0, Foo::copies);
+        EXPECT_EQ(9, Foo::moves);
+
+        // an element of the vector itself survives the relocation
+        vector<Foo> y;
+        for (int k = 0; k < 8; ++k) { y.emplace_back(); }
+        Foo::reset();
+        y.push_back(y[0]);
+        EXPECT_EQ(1, Foo::copies);
+        EXPECT_EQ(8, Foo::moves);
+        EXPECT_TRUE(y[8].alive);
+        EXPECT_TRUE(y[0].alive);
+    }
+}
+
+TEST(Temporaries, AliasedPushes) {
+    vector<std::string> x{ "a", "b", "c", "d", "e", "f", "g", "h" };
+    std::deque<std::string> d(x.begin(), x.end());
+    for (int k = 0; k < 20; ++k) {
+        x.push_front(x.back()); // each one may grow or recenter the vector
+        d.push_front(d.back());
+        x.push_back(std::move(x[1]));
+        d.push_back(std::move(d[1]));
+    }
+    ASSERT_EQ(d.size(), x.size());
+    for (uint64_t k = 0; k < d.size(); ++k) { EXPECT_EQ(d[k], x[k]); }
+}
+
+namespace {
+    // a move that may throw: growth must copy so that it can be undone
+    struct Risky {
+        static int copies;
+        static int fail_after;
+        int value;
+
+        Risky(int value) : value(value) {}
+        Risky(const Risky& that) : value(that.value) {
+            if (fail_after-- == 0) { throw std::runtime_error("copy failed"); }
+            ++copies;
+        }
+        Risky(Risky&& that) : value(that.value) {}
+    };
+    int Risky::copies = 0;
+    int Risky::fail_after = -1;
+} //namespace
+
+TEST(Temporaries, NoexceptMoves) {
+    static_assert(std::is_nothrow_move_constructible<vector<Foo>>::value, "vector moves without throwing");
+    static_assert(std::is_nothrow_move_assignable<vector<Foo>>::value, "vector moves without throwing");
+
+    Foo::reset();
+    {
+        std::vector<vector<Foo>> outer(1);
+        outer[0].emplace_back();
+        for (int k = 0; k < 16; ++k) { outer.emplace_back(); } // reallocates outer several times
+        EXPECT_EQ(0, Foo::copies);
+        EXPECT_EQ(0, Foo::moves);
+    }
+
+    vector<Risky> x;
+    for (int k = 0; k < 8; ++k) { x.emplace_back(k); }
+    Risky::copies = 0;
+    Risky::fail_after = 3;
+    EXPECT_THROW(x.emplace_back(8), std::runtime_error);
+    EXPECT_EQ(8, x.size());
+    EXPECT_EQ(8, x.capacity());
+    EXPECT_EQ(7, x[7].value);
+    Risky::fail_after = -1;
+    Risky::copies = 0;
+    x.emplace_back(8);
+    EXPECT_EQ(8, Risky::copies);
+    EXPECT_EQ(8, x[8].value);
+}
+
+/*****************************************************************************************/
+// Relocation
+/*****************************************************************************************/
+namespace {
+    // owns heap memory, so it is not trivially copyable, but it never refers
+    // to its own address and can therefore be relocated with memcpy
+    class Handle {
+    public:
+        int* value;
+
+        explicit Handle(int v = 0) : value(new int(v)) {}
+        Handle(const Handle& that) : value(new int(*that.value)) {}
+        Handle(Handle&& that) noexcept : value(that.value) { that.value = nullptr; }
+        ~Handle(void) { delete value; }
+    };
+} //namespace
+
+namespace epl {
+    template <>
+    struct is_trivially_relocatable<Handle> : std::true_type {};
+}
+
+TEST(Relocation, TriviallyCopyableGrowth) {
+    vector<int> x;
+    for (int k = 0; k < 100; ++k) {
+        x.push_back(k);
+        x.push_front(-k);
+    }
+
+    EXPECT_EQ(200, x.size());
+    for (int k = 0; k < 100; ++k) {
+        EXPECT_EQ(-99 + k, x[k]);
+        EXPECT_EQ(k, x[100 + k]);
+    }
+}
+
+TEST(Relocation, OptInTrait) {
+    {
+        vector<Handle> x;
+        for (int k = 0; k < 100; ++k) {
+            x.push_back(Handle(k));
+            x.push_front(Handle(-k));
+        }
+
+        EXPECT_EQ(200, x.size());
+        for (int k = 0; k < 100; ++k) {
+            EXPECT_EQ(-99 + k, *x[k].value);
+            EXPECT_EQ(k, *x[100 + k].value);
+        }
+    } // relocated handles must each be freed exactly once
+}
+
+/*****************************************************************************************/
+// Checking policies
+/*****************************************************************************************/
+TEST(Checking, UncheckedIteratorsArePointers) {
+    typedef vector<int, epl::unchecked> Unchecked;
+    static_assert(std::is_same<Unchecked::iterator, int*>::value, "unchecked iterator should be a pointer");
+    static_assert(std::is_same<Unchecked::const_iterator, const int*>::value, "unchecked const_iterator should be a pointer");
+
+    Unchecked x;
+    for (int k = 0; k < 10; ++k) {
+        x.push_back(k);
+    }
+
+    int sum = 0;
+    for (int v : x) {
+        sum += v;
+    }
+    EXPECT_EQ(45, sum);
+    EXPECT_EQ(&x[0], x.begin());
+    EXPECT_EQ(&x[0] + 10, x.end());
+}
+
+TEST(Checking, CheckedIteratorsDetectModification) {
+    vector<int, epl::checked> x(4);
+
+    auto it = x.begin();
+    x.push_back(1); // grows the buffer
+    EXPECT_THROW(*it, epl::invalid_iterator);
+
+    it = x.begin();
+    x.pop_back(); // same buffer, it still points at an element
+    try {
+        *it;
+        FAIL() << "expected invalid_iterator";
+    } catch (epl::invalid_iterator& e) {
+        EXPECT_EQ(epl::invalid_iterator::MILD, e.level);
+    }
+}
+
+TEST(Checking, CheckedIteratorsAreCompact) {
+    typedef vector<int, epl::checked> Checked;
+    static_assert(sizeof(Checked::iterator) == sizeof(void*) + 2 * sizeof(uint64_t), "checked iterator should be a pointer, an index and a stamp");
+    static_assert(sizeof(Checked::const_iterator) == sizeof(void*) + 2 * sizeof(uint64_t), "checked const_iterator should be a pointer, an index and a stamp");
+
+    Checked x(8);
+    auto it = x.begin() + 2;
+    x.push_back(1); // grows the buffer
+    for (int k = 0; k < 100; ++k) {
+        x[0] = k;
+        x.pop_back();
+        x.push_back(k);
+    }
+    try {
+        *it;
+        FAIL() << "expected invalid_iterator";
+    } catch (epl::invalid_iterator& e) {
+        EXPECT_EQ(epl::invalid_iterator::MODERATE, e.level);
+    }
+
+    it = x.end() - 1;
+    x.pop_back();
+    x.pop_back();
+    try {
+        *it;
+        FAIL() << "expected invalid_iterator";
+    } catch (epl::invalid_iterator& e) {
+        EXPECT_EQ(epl::invalid_iterator::SEVERE, e.level);
+    }
+
+    auto first = x.begin();
+    EXPECT_EQ(7, x.end() - first);
+    EXPECT_TRUE(first + 7 == x.end());
+}
@@ -0,0 +1,156 @@
+/*
+ * Vector_SmallVector_unittests.cpp
+ *
+ * Tests for epl::small_vector, the inline-capacity flavour of epl::vector.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "gtest/gtest.h"
+#include "Vector.h"
+
+using epl::small_vector;
+
+namespace {
+    uint64_t heap_allocations = 0;
+
+    template <typename T>
+    class TrackingAllocator : public std::allocator<T> {
+    public:
+        template <typename U> struct rebind { typedef TrackingAllocator<U> other; };
+
+        TrackingAllocator(void) {}
+        template <typename U>
+        TrackingAllocator(const TrackingAllocator<U>&) {}
+
+        T* allocate(size_t n) { ++heap_allocations; return std::allocator<T>::allocate(n); }
+    };
+
+    typedef small_vector<int, 4, epl::checked, TrackingAllocator<int>> Small;
+
+    // a move constructor that may throw, so inline elements must be copied
+    struct MayThrowOnMove {
+        static int moves;
+        static int copies_left;
+        int value;
+
+        MayThrowOnMove(int value) : value(value) {}
+        MayThrowOnMove(const MayThrowOnMove& that) : value(that.value) {
+            if (copies_left-- == 0) { throw std::runtime_error("copy failed"); }
+        }
+        MayThrowOnMove(MayThrowOnMove&& that) : value(that.value) { ++moves; }
+        MayThrowOnMove& operator=(const MayThrowOnMove&) = default;
+    };
+    int MayThrowOnMove::moves = 0;
+    int MayThrowOnMove::copies_left = 1000;
+
+    struct MoveOnlyMayThrow {
+        std::unique_ptr<int> p;
+        MoveOnlyMayThrow(MoveOnlyMayThrow&& that) : p(std::move(that.p)) {}
+    };
+} //namespace
+
+TEST(SmallVector, StaysInline) {
+    heap_allocations = 0;
+    Small x;
+    x.push_back(1);
+    x.push_front(0);
+    x.push_back(2);
+    x.push_front(-1);
+
+    EXPECT_EQ(0, heap_allocations);
+    ASSERT_EQ(4, x.size());
+    for (int k = 0; k < 4; ++k) {
+        EXPECT_EQ(k - 1, x[k]);
+    }
+    EXPECT_TRUE(reinterpret_cast<char*>(x.data()) >= reinterpret_cast<char*>(&x));
+    EXPECT_TRUE(reinterpret_cast<char*>(x.data()) < reinterpret_cast<char*>(&x + 1));
+}
+
+TEST(SmallVector, SpillsToHeap) {
+    heap_allocations = 0;
+    Small x;
+    for (int k = 0; k < 4; ++k) {
+        x.push_back(k);
+    }
+    auto it = x.begin();
+    for (int k = 4; k < 20; ++k) {
+        x.push_back(k);
+    }
+
+    EXPECT_LT(0, heap_allocations);
+    EXPECT_THROW(*it, epl::invalid_iterator);
+    ASSERT_EQ(20, x.size());
+    for (int k = 0; k < 20; ++k) {
+        EXPECT_EQ(k, x[k]);
+    }
+}
+
+TEST(SmallVector, MoveInlineAndHeap) {
+    small_vector<std::string, 2> a;
+    a.push_back("inline");
+    small_vector<std::string, 2> b(std::move(a)); // elements relocate
+    EXPECT_EQ(1, b.size());
+    EXPECT_EQ("inline", b[0]);
+    EXPECT_EQ(0, a.size());
+    a.push_back("reused"); // moved-from vector is empty and usable
+    EXPECT_EQ("reused", a[0]);
+
+    small_vector<std::string, 2> c;
+    for (int k = 0; k < 10; ++k) {
+        c.push_front(std::to_string(k));
+    }
+    const std::string* buffer = c.data();
+    small_vector<std::string, 2> d(std::move(c)); // heap buffer is stolen
+    EXPECT_EQ(buffer, d.data());
+    EXPECT_EQ("9", d.front());
+    EXPECT_EQ("0", d.back());
+
+    b = std::move(d);
+    EXPECT_EQ(10, b.size());
+    d = std::move(a);
+    EXPECT_EQ("reused", d[0]);
+}
+
+TEST(SmallVector, ThrowingMovesAreNotRelocated) {
+    static_assert(!std::is_nothrow_move_constructible<small_vector<MoveOnlyMayThrow, 4>>::value,
+                  "moving inline elements whose move may throw must not be noexcept");
+    static_assert(std::is_nothrow_move_constructible<small_vector<std::unique_ptr<int>, 4>>::value,
+                  "moving inline elements whose move cannot throw is noexcept");
+
+    small_vector<MayThrowOnMove, 4> x;
+    x.push_back(1);
+    x.push_back(2);
+    MayThrowOnMove::moves = 0;
+    small_vector<MayThrowOnMove, 4> y(std::move(x));
+    EXPECT_EQ(0, MayThrowOnMove::moves); // copied, not moved
+    ASSERT_EQ(2, y.size());
+    EXPECT_EQ(2, y[1].value);
+
+    small_vector<MayThrowOnMove, 4> z;
+    for (int k = 0; k < 8; ++k) { z.push_back(k); }
+    while (z.size() > 3) { z.pop_back(); }
+    MayThrowOnMove::copies_left = 1;
+    EXPECT_THROW(z.shrink_to_fit(), std::runtime_error);
+    MayThrowOnMove::copies_left = 1000;
+    ASSERT_EQ(3, z.size()); // nothing lost
+    for (int k = 0; k < 3; ++k) { EXPECT_EQ(k, z[k].value); }
+}
+
+TEST(SmallVector, CopyAndConvert) {
+    small_vector<int, 8> x;
+    for (int k = 0; k < 5; ++k) {
+        x.push_back(k);
+    }
+    small_vector<int, 8> y(x);
+    epl::vector<int> z(x);
+
+    EXPECT_EQ(5, y.size());
+    EXPECT_EQ(5, z.size());
+    EXPECT_EQ(4, y[4]);
+    EXPECT_EQ(4, z[4]);
+}
@@ -0,0 +1,138 @@
+/*
+ * Vector_SoaVector_unittests.cpp
+ *
+ * Tests for epl::soa_vector: columns growing together at both ends, column
+ * spans, proxy references, rollback on a throwing column and iterator
+ * invalidation.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+#include "gtest/gtest.h"
+#include "SoaVector.h"
+
+using epl::soa_vector;
+
+namespace {
+    struct Throwing {
+        static int live;
+        int value;
+
+        Throwing(int value) : value(value) {
+            if (value < 0) { throw std::runtime_error("negative"); }
+            ++live;
+        }
+        Throwing(const Throwing& that) : value(that.value) { ++live; }
+        ~Throwing(void) { --live; }
+    };
+    int Throwing::live = 0;
+} //namespace
+
+TEST(SoaVector, BothEnds) {
+    soa_vector<int, double, std::string> x;
+    EXPECT_EQ(0, x.size());
+    EXPECT_EQ(3, x.column_count);
+    for (int k = 0; k < 1000; ++k) {
+        if (k % 3 == 0) {
+            x.push_front(std::make_tuple(-k, k * 0.5, std::to_string(k)));
+        } else {
+            x.emplace_back(k, k * 0.5, std::to_string(k));
+        }
+    }
+    EXPECT_EQ(1000, x.size());
+    EXPECT_EQ(x.column<0>().size(), x.column<2>().size());
+
+    // the front holds the pushed-front rows in reverse order
+    EXPECT_EQ(-999, std::get<0>(x.front()));
+    EXPECT_EQ("999", std::get<2>(x.front()));
+    EXPECT_EQ(998, std::get<0>(x.back()));
+    EXPECT_DOUBLE_EQ(499.0, std::get<1>(x.back()));
+    EXPECT_THROW(x[1000], std::out_of_range);
+
+    for (int k = 0; k < 1000; ++k) {
+        const int v = std::get<0>(x[k]);
+        EXPECT_EQ(std::to_string(v < 0 ? -v : v), std::get<2>(x[k]));
+    }
+
+    x.pop_front();
+    x.pop_back();
+    EXPECT_EQ(998, x.size());
+    EXPECT_EQ(-996, std::get<0>(x.front()));
+    EXPECT_EQ(997, std::get<0>(x.back()));
+
+    soa_vector<int, double> empty;
+    EXPECT_THROW(empty.pop_back(), std::out_of_range);
+    EXPECT_THROW(empty.front(), std::out_of_range);
+}
+
+TEST(SoaVector, ColumnsAndProxies) {
+    soa_vector<int, double> x{ std::make_tuple(1, 1.5), std::make_tuple(2, 2.5), std::make_tuple(3, 3.5) };
+    epl::column_span<double> prices = x.column<1>();
+    EXPECT_EQ(3, prices.size());
+    EXPECT_DOUBLE_EQ(7.5, std::accumulate(prices.begin(), prices.end(), 0.0));
+    prices[0] = 10.0;
+
+    // a proxy reference writes through to every column
+    std::get<0>(x[1]) = 20;
+    x[2] = std::make_tuple(30, 30.5);
+    EXPECT_TRUE(std::make_tuple(1, 10.0) == x[0]);
+    EXPECT_EQ(20, x.column<0>()[1]);
+    EXPECT_DOUBLE_EQ(30.5, x.column<1>()[2]);
+
+    const soa_vector<int, double>& c = x;
+    EXPECT_EQ(51, std::accumulate(c.column<0>().begin(), c.column<0>().end(), 0));
+    EXPECT_EQ(2, std::count_if(c.begin(), c.end(), [](std::tuple<const int&, const double&> r) {
+        return std::get<0>(r) > 10;
+    }));
+
+    auto it = std::find_if(x.begin(), x.end(), [](std::tuple<int&, double&> r) { return std::get<0>(r) == 20; });
+    ASSERT_TRUE(it != x.end());
+    EXPECT_EQ(1, it - x.begin());
+    std::get<1>(*it) = -1.0;
+    EXPECT_DOUBLE_EQ(-1.0, x.column<1>()[1]);
+
+    soa_vector<int, double>::const_iterator ci = x.begin();
+    EXPECT_TRUE(ci == c.cbegin());
+    EXPECT_EQ(3, c.cend() - ci);
+}
+
+TEST(SoaVector, ThrowingColumnRollsBack) {
+    {
+        soa_vector<std::string, Throwing> x;
+        x.emplace_back("a", 1);
+        EXPECT_THROW(x.emplace_back("b", -1), std::runtime_error);
+        EXPECT_THROW(x.emplace_front("c", -1), std::runtime_error);
+        EXPECT_EQ(1, x.size());
+        EXPECT_EQ(1, x.column<0>().size());
+        x.emplace_front("d", 4);
+        EXPECT_EQ("d", std::get<0>(x.front()));
+        EXPECT_EQ(1, std::get<1>(x.back()).value);
+        EXPECT_EQ(2, Throwing::live);
+    }
+    EXPECT_EQ(0, Throwing::live);
+}
+
+TEST(SoaVector, IteratorInvalidation) {
+    if (! epl::default_checking::enabled) { return; }
+    soa_vector<int, int> x;
+    x.reserve(4);
+    x.emplace_back(1, 1);
+    x.emplace_back(2, 2);
+
+    auto it = x.begin();
+    x.emplace_back(3, 3);
+    try { *it; FAIL(); } catch (const epl::invalid_iterator& ex) { EXPECT_EQ(epl::invalid_iterator::MILD, ex.level); }
+
+    it = x.begin();
+    for (int k = 0; k < 10; ++k) { x.emplace_back(k, k); } // outgrows the reservation
+    try { *it; FAIL(); } catch (const epl::invalid_iterator& ex) { EXPECT_EQ(epl::invalid_iterator::MODERATE, ex.level); }
+
+    auto last = x.end() - 1;
+    x.pop_back();
+    try { *last; FAIL(); } catch (const epl::invalid_iterator& ex) { EXPECT_EQ(epl::invalid_iterator::SEVERE, ex.level); }
+}
@@ -0,0 +1,164 @@
+/*
+ * Vector_Sort_unittests.cpp
+ *
+ * Tests for epl::sort and epl::sort_by_key: radix-sorted integer and float
+ * keys against std::sort, projections, the comparison fallback and the
+ * multithreaded paths.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "Sort.h"
+
+using epl::vector;
+
+namespace {
+    template <typename T>
+    vector<T> random_vector(uint64_t n, uint64_t seed) {
+        std::mt19937_64 rng(seed);
+        vector<T> x;
+        for (uint64_t k = 0; k < n; ++k) {
+            T v = static_cast<T>(rng());
+            if (k % 2) { x.push_front(v); } else { x.push_back(v); }
+        }
+        return x;
+    }
+
+    template <typename T>
+    std::vector<T> sorted_copy(const vector<T>& x) {
+        std::vector<T> copy(x.begin(), x.end());
+        std::sort(copy.begin(), copy.end());
+        return copy;
+    }
+
+    template <typename T>
+    std::vector<T> contents(const vector<T>& x) {
+        return std::vector<T>(x.begin(), x.end());
+    }
+
+    struct Record {
+        uint32_t id;
+        float score;
+    };
+} //namespace
+
+TEST(Sort, IntegerKeys) {
+    for (uint64_t n : { 0, 1, 100, 5000 }) {
+        vector<uint32_t> a = random_vector<uint32_t>(n, n);
+        std::vector<uint32_t> expected = sorted_copy(a);
+        epl::sort(a);
+        EXPECT_EQ(expected, contents(a));
+
+        vector<int64_t> b = random_vector<int64_t>(n, n + 1);
+        b.push_back(std::numeric_limits<int64_t>::min());
+        b.push_back(std::numeric_limits<int64_t>::max());
+        std::vector<int64_t> expected_b = sorted_copy(b);
+        epl::sort(b);
+        EXPECT_EQ(expected_b, contents(b));
+    }
+
+    // a narrow range only needs the low passes
+    vector<uint64_t> narrow;
+    for (uint64_t k = 0; k < 3000; ++k) { narrow.push_back((k * 7919) % 1000); }
+    std::vector<uint64_t> expected = sorted_copy(narrow);
+    epl::sort(narrow);
+    EXPECT_EQ(expected, contents(narrow));
+}
+
+TEST(Sort, FloatKeys) {
+    std::mt19937 rng(3);
+    std::normal_distribution<float> dist(0.0f, 1000.0f);
+    vector<float> x;
+    for (int k = 0; k < 5000; ++k) { x.push_back(dist(rng)); }
+    x.push_back(-std::numeric_limits<float>::infinity());
+    x.push_back(std::numeric_limits<float>::infinity());
+    x.push_back(0.0f);
+    std::vector<float> expected = sorted_copy(x);
+    epl::sort(x);
+    EXPECT_EQ(expected, contents(x));
+
+    vector<double> d{ 2.5, -1.0, 0.0, -1e300, 1e-300, 3.0 };
+    epl::sort(d);
+    EXPECT_EQ((std::vector<double>{ -1e300, -1.0, 0.0, 1e-300, 2.5, 3.0 }), contents(d));
+}
+
+TEST(Sort, FloatNaNsAndZeros) {
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    // below and above the radix cutoff
+    for (int n : { 100, 5000 }) {
+        vector<float> x;
+        std::mt19937 rng(n);
+        std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+        for (int k = 0; k < n; ++k) { x.push_back(dist(rng)); }
+        x.push_back(nan);
+        x.push_back(-nan);
+        x.push_back(0.0f);
+        x.push_back(-0.0f);
+        epl::sort(x);
+
+        ASSERT_TRUE(std::isnan(x.front()) && std::signbit(x.front()));
+        ASSERT_TRUE(std::isnan(x.back()) && ! std::signbit(x.back()));
+        EXPECT_TRUE(std::is_sorted(x.begin() + 1, x.end() - 1));
+        uint64_t zero = std::find(x.begin(), x.end(), 0.0f) - x.begin();
+        ASSERT_LT(zero + 1, x.size());
+        EXPECT_TRUE(std::signbit(x[zero]));
+        EXPECT_FALSE(std::signbit(x[zero + 1]));
+        EXPECT_EQ(0.0f, x[zero + 1]);
+    }
+}
+
+TEST(Sort, ProjectionIsStable) {
+    vector<Record> x;
+    for (uint32_t k = 0; k < 2000; ++k) { x.push_back(Record{ k, (float) (k % 10) }); }
+    epl::sort_by_key(x, [](const Record& r) { return r.score; });
+    for (uint64_t k = 1; k < x.size(); ++k) {
+        ASSERT_LE(x[k - 1].score, x[k].score);
+        if (x[k - 1].score == x[k].score) { ASSERT_LT(x[k - 1].id, x[k].id); }
+    }
+}
+
+TEST(Sort, ComparisonFallback) {
+    vector<std::string> x;
+    for (int k = 0; k < 1000; ++k) { x.push_back(std::to_string((k * 7919) % 1000)); }
+    std::vector<std::string> expected = sorted_copy(x);
+    epl::sort(x);
+    EXPECT_EQ(expected, contents(x));
+
+    epl::sort_by_key(x, [](const std::string& s) { return s.size(); }); // not trivially copyable
+    EXPECT_TRUE(std::is_sorted(x.begin(), x.end(), [](const std::string& a, const std::string& b) { return a.size() < b.size(); }));
+
+    vector<int> y{ 3, 1, 2 };
+    epl::sort(y, std::greater<int>());
+    EXPECT_EQ((std::vector<int>{ 3, 2, 1 }), contents(y));
+}
+
+TEST(Sort, Multithreaded) {
+    epl::thread_pool pool(4);
+    const uint64_t n = 3 * epl::parallel_sort_threshold + 17;
+
+    vector<uint64_t> a = random_vector<uint64_t>(n, 5);
+    std::vector<uint64_t> expected = sorted_copy(a);
+    epl::sort(pool, a);
+    EXPECT_EQ(expected, contents(a));
+
+    vector<Record> r;
+    for (uint64_t k = 0; k < n; ++k) { r.push_back(Record{ (uint32_t) k, (float) (k % 1000) - 500.0f }); }
+    epl::sort_by_key(pool, r, [](const Record& x) { return x.score; });
+    for (uint64_t k = 1; k < n; ++k) {
+        ASSERT_LE(r[k - 1].score, r[k].score);
+        if (r[k - 1].score == r[k].score) { ASSERT_LT(r[k - 1].id, r[k].id); }
+    }
+
+    vector<std::string> s;
+    for (uint64_t k = 0; k < n; ++k) { s.push_back(std::to_string((k * 7919) % n)); }
+    epl::sort(pool, s);
+    EXPECT_TRUE(std::is_sorted(s.begin(), s.end()));
+    epl::release_sort_scratch();
+}
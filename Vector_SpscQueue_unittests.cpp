@@ -0,0 +1,170 @@
+/*
+ * Vector_SpscQueue_unittests.cpp
+ *
+ * Tests for epl::spsc_queue: single-threaded semantics, growth, element
+ * lifetimes, and a producer/consumer stress test.
+ */
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "SpscQueue.h"
+#include "Vector.h"
+
+namespace {
+    struct Tracked {
+        static int live;
+        uint64_t value;
+
+        Tracked(uint64_t value = 0) : value(value) { ++live; }
+        Tracked(const Tracked& that) : value(that.value) { ++live; }
+        Tracked& operator=(const Tracked&) = default;
+        ~Tracked(void) { --live; }
+    };
+    int Tracked::live = 0;
+
+    struct ThrowsOnCopy {
+        static int copies_left;
+        int value;
+
+        ThrowsOnCopy(int value = 0) : value(value) {}
+        ThrowsOnCopy(const ThrowsOnCopy& that) : value(that.value) {
+            if (copies_left-- == 0) { throw std::runtime_error("copy"); }
+        }
+        ThrowsOnCopy& operator=(const ThrowsOnCopy&) = default;
+    };
+    int ThrowsOnCopy::copies_left = 0;
+} //namespace
+
+TEST(SpscQueue, FixedCapacity) {
+    epl::spsc_queue<int> q(20);
+    EXPECT_EQ(32, q.capacity());
+    EXPECT_TRUE(q.empty());
+
+    int k = 0;
+    while (q.try_push(k)) { ++k; }
+    EXPECT_EQ(32, k);
+    EXPECT_EQ(32, q.size());
+
+    int v = -1;
+    for (k = 0; k < 10; ++k) {
+        ASSERT_TRUE(q.try_pop(v));
+        EXPECT_EQ(k, v);
+    }
+    EXPECT_TRUE(q.try_push(100));
+    EXPECT_EQ(23, q.size());
+    EXPECT_EQ(32, q.capacity());
+}
+
+TEST(SpscQueue, GrowsAndKeepsOrder) {
+    epl::spsc_queue<std::string> q(16);
+    std::string s;
+    int expect = 0;
+    for (int k = 0; k < 1000; ++k) {
+        q.push(std::to_string(k));
+        if (k % 3 == 0) {
+            ASSERT_TRUE(q.try_pop(s));
+            EXPECT_EQ(std::to_string(expect++), s);
+        }
+    }
+    EXPECT_GE(q.capacity(), 512);
+    EXPECT_EQ(1000 - expect, q.size());
+
+    while (q.try_pop(s)) {
+        EXPECT_EQ(std::to_string(expect++), s);
+    }
+    EXPECT_EQ(1000, expect);
+    EXPECT_TRUE(q.empty());
+    EXPECT_EQ(0, q.size());
+}
+
+TEST(SpscQueue, Batches) {
+    epl::spsc_queue<int> q(16);
+    epl::vector<int> in;
+    for (int k = 0; k < 100; ++k) { in.push_back(k); }
+
+    EXPECT_EQ(16, q.try_push(in.begin(), in.end()));
+    q.push(in.begin() + 16, in.end());
+    EXPECT_EQ(100, q.size());
+
+    int out[100];
+    EXPECT_EQ(30, q.try_pop(out, 30));
+    EXPECT_EQ(70, q.try_pop(out + 30, 1000));
+    EXPECT_EQ(0, q.try_pop(out, 1));
+    for (int k = 0; k < 100; ++k) { ASSERT_EQ(k, out[k]); }
+}
+
+TEST(SpscQueue, DestroysElements) {
+    {
+        epl::spsc_queue<Tracked> q(16);
+        for (int k = 0; k < 100; ++k) { q.push(Tracked(k)); }
+        Tracked t;
+        for (int k = 0; k < 40; ++k) { q.try_pop(t); }
+        EXPECT_EQ(61, Tracked::live);
+    }
+    EXPECT_EQ(0, Tracked::live);
+}
+
+TEST(SpscQueue, ThrowingBatchKeepsPrefix) {
+    epl::spsc_queue<ThrowsOnCopy> q(16);
+    ThrowsOnCopy batch[5] = { 0, 1, 2, 3, 4 };
+    ThrowsOnCopy::copies_left = 3;
+    EXPECT_THROW(q.try_push(batch, batch + 5), std::runtime_error);
+    EXPECT_EQ(3, q.size());
+    ThrowsOnCopy out;
+    for (int k = 0; k < 3; ++k) {
+        EXPECT_TRUE(q.try_pop(out));
+        EXPECT_EQ(k, out.value);
+    }
+    EXPECT_FALSE(q.try_pop(out));
+}
+
+TEST(SpscQueue, ProducerConsumerStress) {
+    const uint64_t count = 2000000;
+    for (bool growable : { false, true }) {
+        epl::spsc_queue<uint64_t> q(growable ? 16 : 1024);
+        std::thread producer([&q, growable, count] {
+            uint64_t batch[7];
+            uint64_t k = 0;
+            while (k < count) {
+                EXPECT_LE(q.size(), k); // the consumer may be freeing rings meanwhile
+                if (k % 5 == 0 && k + 7 <= count) {
+                    for (uint64_t j = 0; j < 7; ++j) { batch[j] = k + j; }
+                    if (growable) {
+                        q.push(batch, batch + 7);
+                        k += 7;
+                    } else {
+                        k += q.try_push(batch, batch + 7);
+                    }
+                } else if (growable) {
+                    q.push(k++);
+                } else if (q.try_push(k)) {
+                    ++k;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        uint64_t expect = 0, out[13];
+        bool ordered = true, bounded = true;
+        while (expect < count) {
+            bounded = bounded && q.size() <= count - expect; // popped never passes pushed
+            uint64_t n = 0;
+            if (expect % 2) {
+                n = q.try_pop(out, 13);
+            } else if (q.try_pop(out[0])) {
+                n = 1;
+            }
+            if (n == 0) { std::this_thread::yield(); }
+            for (uint64_t j = 0; j < n; ++j) { ordered = ordered && out[j] == expect++; }
+        }
+        producer.join();
+        EXPECT_TRUE(ordered) << growable;
+        EXPECT_TRUE(bounded) << growable;
+        EXPECT_TRUE(q.empty());
+    }
+}
@@ -0,0 +1,121 @@
+/*
+ * Vector_StaticVector_unittests.cpp
+ *
+ * Tests for epl::static_vector: compile-time construction, both ends with
+ * sliding, the error policies, non-trivial elements and iterator checks.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "StaticVector.h"
+
+using epl::static_vector;
+
+namespace {
+    constexpr static_vector<int, 16> squares(void) {
+        static_vector<int, 16> v;
+        for (int k = 0; k < 8; ++k) { v.push_back(k * k); }
+        for (int k = 1; k < 9; ++k) { v.push_front(-k * k); } // slides once the front fills up
+        return v;
+    }
+
+    constexpr int sum(const static_vector<int, 16>& v) {
+        int total = 0;
+        for (uint64_t k = 0; k < v.size(); ++k) { total += v[k]; }
+        return total;
+    }
+
+    struct Point {
+        int x = 0;
+        int y = 0;
+        constexpr Point(void) {}
+        constexpr Point(int x, int y) : x(x), y(y) {}
+    };
+
+    struct Tracked {
+        static int live;
+        std::string name;
+
+        Tracked(const char* name) : name(name) { ++live; }
+        Tracked(const Tracked& that) : name(that.name) { ++live; }
+        Tracked(Tracked&& that) noexcept : name(std::move(that.name)) { ++live; }
+        ~Tracked(void) { --live; }
+    };
+    int Tracked::live = 0;
+} //namespace
+
+TEST(StaticVector, Constexpr) {
+    constexpr static_vector<int, 16> table = squares();
+    static_assert(table.size() == 16, "full");
+    static_assert(table.front() == -64 && table.back() == 49, "order");
+    static_assert(sum(table) == 0 + 1 + 4 + 9 + 16 + 25 + 36 + 49 - 1 - 4 - 9 - 16 - 25 - 36 - 49 - 64, "sum");
+    static_assert(static_vector<int, 16>::capacity() == 16, "capacity");
+
+    constexpr static_vector<Point, 4> corners{ Point(0, 0), Point(0, 1), Point(1, 0), Point(1, 1) };
+    static_assert(corners[3].x == 1 && corners[3].y == 1, "points");
+    EXPECT_EQ(16, table.size());
+    EXPECT_TRUE(std::is_sorted(table.begin() + 8, table.end()));
+}
+
+TEST(StaticVector, BothEndsAndOverflow) {
+    static_vector<int, 4> x;
+    x.push_back(1);
+    x.push_back(2);
+    x.push_back(3); // slides to the front
+    x.push_front(0);
+    EXPECT_EQ(4, x.size());
+    for (int k = 0; k < 4; ++k) { EXPECT_EQ(k, x[k]); }
+    EXPECT_THROW(x.push_back(4), std::length_error);
+    EXPECT_THROW(x.push_front(-1), std::length_error);
+    EXPECT_THROW(x[4], std::out_of_range);
+    x.pop_front();
+    x.push_back(4); // the freed front slot is reused
+    EXPECT_EQ(1, x.front());
+    EXPECT_EQ(4, x.back());
+
+    static_vector<int, 2> y;
+    EXPECT_THROW(y.pop_back(), std::out_of_range);
+    EXPECT_THROW((static_vector<int, 2>{ 1, 2, 3 }), std::length_error);
+}
+
+TEST(StaticVector, NonTrivialElements) {
+    {
+        static_vector<Tracked, 8> x;
+        for (int k = 0; k < 8; ++k) {
+            if (k % 2 == 0) { x.emplace_back("back"); } else { x.emplace_front("front"); }
+        }
+        EXPECT_EQ(8, Tracked::live);
+        EXPECT_EQ("front", x.front().name);
+        EXPECT_EQ("back", x.back().name);
+
+        static_vector<Tracked, 8> y(x);
+        EXPECT_EQ(16, Tracked::live);
+        y.pop_back();
+        y.pop_front();
+        x = y;
+        EXPECT_EQ(12, Tracked::live);
+        EXPECT_EQ(6, x.size());
+    }
+    EXPECT_EQ(0, Tracked::live);
+}
+
+TEST(StaticVector, Iterators) {
+    if (! epl::default_checking::enabled) { return; }
+    static_vector<int, 8> x{ 1, 2, 3 };
+    auto it = x.begin();
+    EXPECT_EQ(6, std::count_if(x.cbegin(), x.cend(), [](int) { return true; }) * 2);
+    x.push_back(4);
+    try { (void) *it; FAIL(); } catch (epl::invalid_iterator& e) { EXPECT_EQ(epl::invalid_iterator::MILD, e.level); }
+
+    auto last = x.end() - 1;
+    x.pop_back();
+    try { (void) *last; FAIL(); } catch (epl::invalid_iterator& e) { EXPECT_EQ(epl::invalid_iterator::SEVERE, e.level); }
+
+    static_vector<int, 4, epl::unchecked> raw{ 5, 6 };
+    int* p = raw.begin();
+    EXPECT_EQ(6, p[1]);
+}
@@ -0,0 +1,91 @@
+/*
+ * Vector_Stats_unittests.cpp
+ *
+ * Tests for the vector instrumentation counters.  Build with
+ * -DEPL_VECTOR_STATS to exercise the counters themselves; without it only the
+ * "disabled" behaviour is checked.
+ */
+
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "Vector.h"
+
+using epl::vector;
+
+#ifdef EPL_VECTOR_STATS
+TEST(Stats, GrowthCounters) {
+    epl::reset_global_vector_stats();
+    vector<int> x; // 8 slots
+    for (int k = 0; k < 9; ++k) {
+        x.push_back(k); // the ninth grows the back
+    }
+    for (int k = 0; k < 20; ++k) {
+        x.push_front(k);
+    }
+
+    epl::vector_stats s = x.stats();
+    EXPECT_LE(2, s.allocations);
+    EXPECT_EQ(1, s.back_reallocations);
+    EXPECT_LE(1, s.front_reallocations);
+    EXPECT_LE(8, s.elements_relocated);
+    EXPECT_EQ(s.elements_relocated * sizeof(int), s.bytes_relocated);
+    EXPECT_EQ(x.capacity(), s.peak_capacity);
+    EXPECT_DOUBLE_EQ(1.0 - 29.0 / x.capacity(), s.slack_ratio);
+
+    epl::vector_stats g = epl::global_vector_stats();
+    EXPECT_EQ(s.allocations, g.allocations);
+    EXPECT_EQ(s.bytes_relocated, g.bytes_relocated);
+
+    x.reset_stats();
+    EXPECT_EQ(0, x.stats().allocations);
+}
+
+TEST(Stats, RecenterAndShrink) {
+    vector<int> q;
+    for (int k = 0; k < 8; ++k) { q.push_back(k); }
+    for (int k = 0; k < 6; ++k) { q.pop_front(); }
+    q.reset_stats();
+    q.push_back(8);
+    EXPECT_EQ(1, q.stats().recenters);
+    EXPECT_EQ(0, q.stats().allocations);
+
+    q.reserve(1000);
+    q.shrink_to_fit();
+    EXPECT_EQ(1, q.stats().shrinks);
+}
+
+TEST(Stats, IteratorFaults) {
+    epl::reset_global_vector_stats();
+    vector<int, epl::checked> x(8);
+    auto it = x.begin();
+    x.push_back(1); // reallocates
+    EXPECT_THROW(*it, epl::invalid_iterator);
+
+    it = x.begin() + 8;
+    x.pop_back();
+    EXPECT_THROW(*it, epl::invalid_iterator); // points past the end now
+
+    it = x.begin();
+    x[0] = 3;
+    x.pop_back();
+    EXPECT_THROW(*it, epl::invalid_iterator);
+
+    epl::vector_stats s = x.stats();
+    EXPECT_EQ(1, s.moderate_faults);
+    EXPECT_EQ(1, s.severe_faults);
+    EXPECT_EQ(1, s.mild_faults);
+    EXPECT_EQ(3, epl::global_vector_stats().moderate_faults + epl::global_vector_stats().severe_faults
+                 + epl::global_vector_stats().mild_faults);
+}
+#else
+TEST(Stats, DisabledCountsNothing) {
+    vector<int> x;
+    for (int k = 0; k < 100; ++k) {
+        x.push_front(k);
+    }
+    EXPECT_EQ(0, x.stats().allocations);
+    EXPECT_EQ(0, epl::global_vector_stats().allocations);
+    EXPECT_LT(0.0, x.stats().slack_ratio); // computed on demand, always available
+}
+#endif
@@ -0,0 +1,122 @@
+/*
+ * Vector_Views_unittests.cpp
+ *
+ * Tests for the lazy views in Views.h: each adapter alone and composed,
+ * the sinks, and iterator checks at the head of a pipeline.
+ */
+
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "Views.h"
+
+using epl::vector;
+namespace views = epl::views;
+
+namespace {
+    template <typename R>
+    std::vector<typename std::iterator_traits<views::iterator_of<R>>::value_type> contents(const R& r) {
+        std::vector<typename std::iterator_traits<views::iterator_of<R>>::value_type> out;
+        for (auto it = r.begin(); it != r.end(); ++it) { out.push_back(*it); }
+        return out;
+    }
+
+    vector<int> iota(int n) {
+        vector<int> x;
+        for (int k = 0; k < n; ++k) { x.push_back(k); }
+        return x;
+    }
+} //namespace
+
+TEST(Views, Adapters) {
+    vector<int> x = iota(10);
+
+    auto squares = views::transform(x, [](int v) { return v * v; });
+    EXPECT_EQ(10, squares.size());
+    EXPECT_EQ((std::vector<int>{ 0, 1, 4, 9, 16, 25, 36, 49, 64, 81 }), contents(squares));
+
+    EXPECT_EQ((std::vector<int>{ 0, 3, 6, 9 }), contents(views::filter(x, [](int v) { return v % 3 == 0; })));
+    EXPECT_EQ((std::vector<int>{ 0, 1, 2 }), contents(views::take(x, 3)));
+    EXPECT_EQ(10, views::take(x, 20).size());
+    EXPECT_EQ((std::vector<int>{ 7, 8, 9 }), contents(views::drop(x, 7)));
+    EXPECT_EQ(0, views::drop(x, 20).size());
+    EXPECT_EQ((std::vector<int>{ 9, 8, 7 }), contents(views::take(views::reverse(x), 3)));
+
+    auto chunks = views::chunk(x, 4);
+    EXPECT_EQ(3, chunks.size());
+    std::vector<uint64_t> sizes;
+    for (auto c : chunks) { sizes.push_back(c.size()); }
+    EXPECT_EQ((std::vector<uint64_t>{ 4, 4, 2 }), sizes);
+    EXPECT_EQ(8, *(*++chunks.begin()).begin() + 4);
+
+    vector<std::string> names{ "a", "b", "c" };
+    auto pairs = views::zip(x, names);
+    EXPECT_EQ(3, pairs.size());
+    std::vector<std::pair<int, std::string>> expected{ { 0, "a" }, { 1, "b" }, { 2, "c" } };
+    EXPECT_EQ(expected, contents(pairs));
+}
+
+TEST(Views, Pipelines) {
+    vector<int> x = iota(100);
+    auto pipeline = x | views::filter([](int v) { return v % 2 == 1; })
+                      | views::transform([](int v) { return v * 10; })
+                      | views::drop(2)
+                      | views::take(3);
+    EXPECT_EQ((std::vector<int>{ 50, 70, 90 }), contents(pipeline));
+
+    // nothing runs until the pipeline is iterated, and it can run again
+    int calls = 0;
+    auto counted = x | views::transform([&calls](int v) { ++calls; return v; }) | views::take(5);
+    EXPECT_EQ(0, calls);
+    EXPECT_EQ(5, views::to_vector(counted).size());
+    EXPECT_EQ(5, calls);
+    EXPECT_EQ(5, views::to_vector(counted).size());
+
+    // writes go through to the source
+    for (int& v : views::reverse(x) | views::take(2)) { v = -1; }
+    EXPECT_EQ(-1, x[99]);
+    EXPECT_EQ(-1, x[98]);
+    EXPECT_EQ(97, x[97]);
+
+    // chunk sums
+    vector<int> sums = views::to_vector(x | views::take(10) | views::chunk(5) | views::transform([](auto c) {
+        int s = 0;
+        for (int v : c) { s += v; }
+        return s;
+    }));
+    EXPECT_EQ((std::vector<int>{ 10, 35 }), std::vector<int>(sums.begin(), sums.end()));
+}
+
+TEST(Views, Sinks) {
+    const vector<int> x = iota(1000);
+    vector<int> out;
+    views::collect(x | views::transform([](int v) { return v + 1; }), out);
+    EXPECT_EQ(1000, out.size());
+    EXPECT_LE(out.capacity(), 1008); // reserved once for the known size
+
+    views::collect(x | views::filter([](int v) { return v < 3; }), out); // size unknown: appended as found
+    EXPECT_EQ(1003, out.size());
+    EXPECT_EQ(2, out.back());
+
+    std::list<std::string> names;
+    views::collect(views::take(x, 2) | views::transform([](int v) { return std::to_string(v); }), names);
+    EXPECT_EQ("1", names.back());
+}
+
+TEST(Views, CheckedAtTheHead) {
+    if (! epl::default_checking::enabled) { return; }
+    vector<int> x = iota(10);
+    auto first = x.begin();
+    auto last = x.end();
+    auto view = views::all(first, last) | views::transform([](int v) { return v * 2; });
+    EXPECT_EQ(18, contents(view).back());
+
+    x.push_back(10); // invalidates the iterators the view was built from
+    EXPECT_THROW(view.begin(), epl::invalid_iterator);
+    EXPECT_THROW(views::to_vector(view), epl::invalid_iterator);
+}
@@ -0,0 +1,1162 @@
+/*
+ * Vector_benchmarks.cpp
+ *
+ * Google Benchmark suite comparing epl::vector with std::vector and
+ * std::deque.  Every case runs for int, a 64-byte POD and std::string, at
+ * sizes from 8 up to 100M elements (10M for std::string, which would not fit
+ * in memory otherwise).
+ *
+ * Build and run (see README.md):
+ *   make bench
+ * or
+ *   g++ -std=c++17 -O2 -DNDEBUG -I. Vector_benchmarks.cpp -lbenchmark -pthread -o vector_bench
+ *   ./vector_bench --benchmark_format=json --benchmark_out=results.json
+ */
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "Allocators.h"
+#include "ChunkedVector.h"
+#include "ConcurrentVector.h"
+#include "FlatMap.h"
+#include "Kernels.h"
+#include "Parallel.h"
+#include "Persistence.h"
+#include "SoaVector.h"
+#include "Sort.h"
+#include "SpscQueue.h"
+#include "Vector.h"
+#include "Views.h"
+
+namespace {
+    struct Pod64 {
+        uint64_t words[8];
+    };
+
+    template <typename T> T make_value(uint64_t k);
+    template <> int make_value<int>(uint64_t k) { return (int) k; }
+    template <> Pod64 make_value<Pod64>(uint64_t k) { Pod64 p = {}; p.words[0] = k; return p; }
+    template <> std::string make_value<std::string>(uint64_t k) { return "value number " + std::to_string(k); }
+
+    template <typename T> uint64_t key(const T& v);
+    template <> uint64_t key<int>(const int& v) { return v; }
+    template <> uint64_t key<Pod64>(const Pod64& v) { return v.words[0]; }
+    template <> uint64_t key<std::string>(const std::string& v) { return v.size(); }
+
+    template <typename T>
+    using checked_vector = epl::vector<T, epl::checked>;
+    template <typename T>
+    using unchecked_vector = epl::vector<T, epl::unchecked>;
+
+    template <typename C>
+    C filled(uint64_t n) {
+        C c;
+        for (uint64_t k = 0; k < n; ++k) {
+            c.push_back(make_value<typename C::value_type>(k));
+        }
+        return c;
+    }
+
+    void sizes(benchmark::internal::Benchmark* b, int64_t max) {
+        for (int64_t n = 8; n <= max; n *= 8) {
+            b->Arg(n);
+        }
+        if (max >= 100000000) { b->Arg(100000000); }
+    }
+
+    void int_sizes(benchmark::internal::Benchmark* b) { sizes(b, 100000000); }
+    void string_sizes(benchmark::internal::Benchmark* b) { sizes(b, 10000000); }
+
+    void set_counters(benchmark::State& state) {
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+} //namespace
+
+/*****************************************************************************************/
+// Insertion
+/*****************************************************************************************/
+template <typename C>
+static void BM_push_back(benchmark::State& state) {
+    typedef typename C::value_type T;
+    const uint64_t n = state.range(0);
+    const T v = make_value<T>(1);
+    for (auto _ : state) {
+        C c;
+        for (uint64_t k = 0; k < n; ++k) {
+            c.push_back(v);
+        }
+        benchmark::DoNotOptimize(&c.back());
+    }
+    set_counters(state);
+}
+
+template <typename C>
+static void BM_push_front(benchmark::State& state) {
+    typedef typename C::value_type T;
+    const uint64_t n = state.range(0);
+    const T v = make_value<T>(1);
+    for (auto _ : state) {
+        C c;
+        for (uint64_t k = 0; k < n; ++k) {
+            c.push_front(v);
+        }
+        benchmark::DoNotOptimize(&c.front());
+    }
+    set_counters(state);
+}
+
+template <typename C>
+static void BM_emplace_back(benchmark::State& state) {
+    typedef typename C::value_type T;
+    const uint64_t n = state.range(0);
+    for (auto _ : state) {
+        C c;
+        for (uint64_t k = 0; k < n; ++k) {
+            c.emplace_back(make_value<T>(k));
+        }
+        benchmark::DoNotOptimize(&c.back());
+    }
+    set_counters(state);
+}
+
+template <typename C>
+static void BM_emplace_front(benchmark::State& state) {
+    typedef typename C::value_type T;
+    const uint64_t n = state.range(0);
+    for (auto _ : state) {
+        C c;
+        for (uint64_t k = 0; k < n; ++k) {
+            c.emplace_front(make_value<T>(k));
+        }
+        benchmark::DoNotOptimize(&c.front());
+    }
+    set_counters(state);
+}
+
+// alternates ends, so both check_back and check_front take part in growth
+template <typename C>
+static void BM_mixed_growth(benchmark::State& state) {
+    typedef typename C::value_type T;
+    const uint64_t n = state.range(0);
+    const T v = make_value<T>(1);
+    for (auto _ : state) {
+        C c;
+        for (uint64_t k = 0; k < n; ++k) {
+            if (k % 3 == 0) { c.push_front(v); } else { c.push_back(v); }
+        }
+        benchmark::DoNotOptimize(&c.front());
+    }
+    set_counters(state);
+}
+
+/*****************************************************************************************/
+// Removal
+/*****************************************************************************************/
+template <typename C>
+static void BM_pop_back(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    for (auto _ : state) {
+        state.PauseTiming();
+        C c = filled<C>(n);
+        state.ResumeTiming();
+        for (uint64_t k = 0; k < n; ++k) {
+            c.pop_back();
+        }
+        benchmark::ClobberMemory();
+    }
+    set_counters(state);
+}
+
+template <typename C>
+static void BM_pop_front(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    for (auto _ : state) {
+        state.PauseTiming();
+        C c = filled<C>(n);
+        state.ResumeTiming();
+        for (uint64_t k = 0; k < n; ++k) {
+            c.pop_front();
+        }
+        benchmark::ClobberMemory();
+    }
+    set_counters(state);
+}
+
+/*****************************************************************************************/
+// Access
+/*****************************************************************************************/
+template <typename C>
+static void BM_index(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    C c = filled<C>(n);
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        for (uint64_t k = 0; k < n; ++k) {
+            sum += key(c[k]);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    set_counters(state);
+}
+
+template <typename C>
+static void BM_iterate(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    C c = filled<C>(n);
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        for (const auto& v : c) {
+            sum += key(v);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    set_counters(state);
+}
+
+// writes through the iterators; for checked iterators the stores may alias
+// the vector's own fields, so nothing can be kept in registers across steps
+template <typename C>
+static void BM_iterate_write(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    C c(n);
+    for (auto _ : state) {
+        for (auto& v : c) { v += 1; }
+        benchmark::ClobberMemory();
+    }
+    set_counters(state);
+}
+
+// std::sort through the container's own iterators, which for checked
+// vectors are copied, compared and validated on every step
+template <typename C>
+static void BM_sort_through_iterators(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    C c(n);
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (uint64_t k = 0; k < n; ++k) { c[k] = (k * 0x9E3779B97F4A7C15ull) >> 16; }
+        state.ResumeTiming();
+        std::sort(c.begin(), c.end());
+        benchmark::ClobberMemory();
+    }
+    set_counters(state);
+}
+
+/*****************************************************************************************/
+// Copy and move
+/*****************************************************************************************/
+template <typename C>
+static void BM_copy_construct(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    C c = filled<C>(n);
+    for (auto _ : state) {
+        C d(c);
+        benchmark::DoNotOptimize(&d);
+    }
+    set_counters(state);
+}
+
+template <typename C>
+static void BM_move_construct(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    C c = filled<C>(n);
+    for (auto _ : state) {
+        C d(std::move(c));
+        benchmark::DoNotOptimize(&d);
+        c = std::move(d);
+    }
+    set_counters(state);
+}
+
+/*****************************************************************************************/
+// Numeric kernels against hand-written operator[] loops
+/*****************************************************************************************/
+template <typename T>
+static void BM_scalar_sum(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    epl::vector<T> x(n);
+    for (auto _ : state) {
+        T s = 0;
+        for (uint64_t k = 0; k < n; ++k) {
+            s += x[k];
+        }
+        benchmark::DoNotOptimize(s);
+    }
+    set_counters(state);
+}
+
+template <typename T>
+static void BM_kernel_sum(benchmark::State& state) {
+    epl::vector<T> x(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(epl::sum(x));
+    }
+    set_counters(state);
+}
+
+template <typename T>
+static void BM_scalar_dot(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    epl::vector<T> x(n), y(n);
+    for (auto _ : state) {
+        T s = 0;
+        for (uint64_t k = 0; k < n; ++k) {
+            s += x[k] * y[k];
+        }
+        benchmark::DoNotOptimize(s);
+    }
+    set_counters(state);
+}
+
+template <typename T>
+static void BM_kernel_dot(benchmark::State& state) {
+    epl::vector<T> x(state.range(0)), y(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(epl::dot(x, y));
+    }
+    set_counters(state);
+}
+
+template <typename T>
+static void BM_scalar_min(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    epl::vector<T> x(n);
+    for (auto _ : state) {
+        T m = x[0];
+        for (uint64_t k = 1; k < n; ++k) {
+            m = x[k] < m ? x[k] : m;
+        }
+        benchmark::DoNotOptimize(m);
+    }
+    set_counters(state);
+}
+
+template <typename T>
+static void BM_kernel_min(benchmark::State& state) {
+    epl::vector<T> x(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(epl::min_value(x));
+    }
+    set_counters(state);
+}
+
+template <typename T>
+static void BM_scalar_axpy(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    epl::vector<T> x(n), y(n);
+    for (auto _ : state) {
+        for (uint64_t k = 0; k < n; ++k) {
+            y[k] += 3 * x[k];
+        }
+        benchmark::ClobberMemory();
+    }
+    set_counters(state);
+}
+
+template <typename T>
+static void BM_kernel_axpy(benchmark::State& state) {
+    epl::vector<T> x(state.range(0)), y(state.range(0));
+    for (auto _ : state) {
+        epl::axpy((T) 3, x, y);
+        benchmark::ClobberMemory();
+    }
+    set_counters(state);
+}
+
+/*****************************************************************************************/
+// Parallel algorithms, scaling from one thread to all hardware threads
+/*****************************************************************************************/
+namespace {
+    void thread_counts(benchmark::internal::Benchmark* b) {
+        const int64_t most = std::max(1u, std::thread::hardware_concurrency());
+        for (int64_t t = 1; t < most; t *= 2) {
+            b->Args({ 1 << 24, t });
+        }
+        b->Args({ 1 << 24, most });
+        b->UseRealTime();
+    }
+} //namespace
+
+static void BM_parallel_for_each(benchmark::State& state) {
+    epl::thread_pool pool(state.range(1));
+    unchecked_vector<double> x(state.range(0));
+    for (auto _ : state) {
+        epl::parallel::for_each(pool, x.begin(), x.end(), [](double& v) { v = v * 1.5 + 1; });
+        benchmark::ClobberMemory();
+    }
+    set_counters(state);
+}
+
+static void BM_parallel_transform(benchmark::State& state) {
+    epl::thread_pool pool(state.range(1));
+    unchecked_vector<double> x(state.range(0)), y(state.range(0));
+    for (auto _ : state) {
+        epl::parallel::transform(pool, x.begin(), x.end(), y.begin(), [](double v) { return std::sqrt(v + 1); });
+        benchmark::ClobberMemory();
+    }
+    set_counters(state);
+}
+
+static void BM_parallel_reduce(benchmark::State& state) {
+    epl::thread_pool pool(state.range(1));
+    unchecked_vector<double> x(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(epl::parallel::reduce(pool, x.begin(), x.end(), 0.0, std::plus<double>()));
+    }
+    set_counters(state);
+}
+
+static void BM_parallel_sort(benchmark::State& state) {
+    epl::thread_pool pool(state.range(1));
+    const uint64_t n = state.range(0);
+    unchecked_vector<uint64_t> x(n);
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (uint64_t k = 0; k < n; ++k) { x[k] = (k * 0x9E3779B97F4A7C15ull) >> 16; }
+        state.ResumeTiming();
+        epl::parallel::sort(pool, x.begin(), x.end());
+        benchmark::ClobberMemory();
+    }
+    set_counters(state);
+}
+
+/*****************************************************************************************/
+// Producer/consumer hand-off: lock-free queue against a vector behind a mutex
+/*****************************************************************************************/
+static void BM_spsc_queue(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    const uint64_t batch = state.range(1);
+    for (auto _ : state) {
+        epl::spsc_queue<uint64_t> q(1 << 14);
+        std::thread producer([&q, n, batch] {
+            uint64_t items[64];
+            for (uint64_t k = 0; k < n; ) {
+                if (batch == 1) {
+                    if (q.try_push(k)) { ++k; } else { std::this_thread::yield(); }
+                } else {
+                    for (uint64_t j = 0; j < batch; ++j) { items[j] = k + j; }
+                    uint64_t pushed = q.try_push(items, items + std::min(batch, n - k));
+                    if (pushed == 0) { std::this_thread::yield(); }
+                    k += pushed;
+                }
+            }
+        });
+        uint64_t sum = 0, items[64];
+        for (uint64_t k = 0; k < n; ) {
+            uint64_t popped = batch == 1 ? q.try_pop(items[0]) : q.try_pop(items, batch);
+            if (popped == 0) { std::this_thread::yield(); }
+            for (uint64_t j = 0; j < popped; ++j) { sum += items[j]; }
+            k += popped;
+        }
+        producer.join();
+        benchmark::DoNotOptimize(sum);
+    }
+    set_counters(state);
+}
+
+static void BM_mutex_vector_queue(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    for (auto _ : state) {
+        unchecked_vector<uint64_t> q;
+        std::mutex lock;
+        std::thread producer([&q, &lock, n] {
+            for (uint64_t k = 0; k < n; ++k) {
+                std::lock_guard<std::mutex> guard(lock);
+                q.push_back(k);
+            }
+        });
+        uint64_t sum = 0;
+        for (uint64_t k = 0; k < n; ) {
+            std::unique_lock<std::mutex> guard(lock);
+            if (q.size() == 0) {
+                guard.unlock();
+                std::this_thread::yield();
+                continue;
+            }
+            sum += q.front();
+            q.pop_front();
+            ++k;
+        }
+        producer.join();
+        benchmark::DoNotOptimize(sum);
+    }
+    set_counters(state);
+}
+
+/*****************************************************************************************/
+// Appends from many threads: concurrent_vector against a vector behind a mutex
+/*****************************************************************************************/
+namespace {
+    void contention(benchmark::internal::Benchmark* b) {
+        for (int64_t t = 1; t <= 64; t *= 2) {
+            b->Args({ 1 << 22, t });
+        }
+        b->UseRealTime();
+    }
+
+    template <typename F>
+    void run_threads(uint64_t threads, F f) {
+        std::vector<std::thread> pool;
+        for (uint64_t t = 0; t < threads; ++t) {
+            pool.emplace_back(f);
+        }
+        for (std::thread& t : pool) { t.join(); }
+    }
+} //namespace
+
+static void BM_concurrent_vector_push_back(benchmark::State& state) {
+    const uint64_t threads = state.range(1);
+    const uint64_t each = state.range(0) / threads;
+    for (auto _ : state) {
+        epl::concurrent_vector<uint64_t> x;
+        run_threads(threads, [&x, each] {
+            for (uint64_t k = 0; k < each; ++k) { x.push_back(k); }
+        });
+        benchmark::DoNotOptimize(x.size());
+    }
+    set_counters(state);
+}
+
+static void BM_mutex_vector_push_back(benchmark::State& state) {
+    const uint64_t threads = state.range(1);
+    const uint64_t each = state.range(0) / threads;
+    for (auto _ : state) {
+        unchecked_vector<uint64_t> x;
+        std::mutex lock;
+        run_threads(threads, [&x, &lock, each] {
+            for (uint64_t k = 0; k < each; ++k) {
+                std::lock_guard<std::mutex> guard(lock);
+                x.push_back(k);
+            }
+        });
+        benchmark::DoNotOptimize(x.size());
+    }
+    set_counters(state);
+}
+
+/*****************************************************************************************/
+// Tail latency of single pushes: growth by reallocation against block growth
+/*****************************************************************************************/
+namespace {
+    // not trivially relocatable, so a reallocating vector moves it element by element
+    struct Record {
+        std::string name;
+        uint64_t fields[12];
+    };
+
+    template <typename C>
+    void push_end(C& c, const Record& r, std::true_type) { c.push_back(r); }
+    template <typename C>
+    void push_end(C& c, const Record& r, std::false_type) { c.push_front(r); }
+} //namespace
+
+template <typename C, bool Back>
+static void BM_push_latency(benchmark::State& state) {
+    typedef std::chrono::steady_clock clock;
+    const uint64_t n = state.range(0);
+    const Record r = { "a record name longer than the small string buffer", {} };
+    std::vector<uint64_t> ns(n);
+    std::vector<uint64_t> all;
+    for (auto _ : state) {
+        C c;
+        for (uint64_t k = 0; k < n; ++k) {
+            clock::time_point t0 = clock::now();
+            push_end(c, r, std::integral_constant<bool, Back>());
+            ns[k] = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - t0).count();
+        }
+        all.insert(all.end(), ns.begin(), ns.end());
+    }
+    std::sort(all.begin(), all.end());
+    state.counters["p50_ns"] = all[all.size() / 2];
+    state.counters["p99_ns"] = all[all.size() * 99 / 100];
+    state.counters["p999_ns"] = all[all.size() * 999 / 1000];
+    state.counters["max_ns"] = all.back();
+    set_counters(state);
+}
+
+/*****************************************************************************************/
+// Start-up: parsing text against load() and a mapped view
+/*****************************************************************************************/
+namespace {
+    const char* startup_text = "/tmp/epl_bench_startup.txt";
+    const char* startup_binary = "/tmp/epl_bench_startup.bin";
+
+    void write_startup_files(uint64_t n) {
+        unchecked_vector<uint64_t> x;
+        std::FILE* f = std::fopen(startup_text, "w");
+        for (uint64_t k = 0; k < n; ++k) {
+            x.push_back(k * 0x9E3779B97F4A7C15ull);
+            std::fprintf(f, "%llu\n", (unsigned long long) x.back());
+        }
+        std::fclose(f);
+        epl::save(x, startup_binary);
+    }
+} //namespace
+
+static void BM_startup_parse_text(benchmark::State& state) {
+    write_startup_files(state.range(0));
+    char line[32];
+    for (auto _ : state) {
+        unchecked_vector<uint64_t> x;
+        std::FILE* f = std::fopen(startup_text, "r");
+        while (std::fgets(line, sizeof(line), f)) {
+            x.push_back(std::strtoull(line, nullptr, 10));
+        }
+        std::fclose(f);
+        benchmark::DoNotOptimize(x.data());
+    }
+    set_counters(state);
+}
+
+static void BM_startup_load(benchmark::State& state) {
+    write_startup_files(state.range(0));
+    for (auto _ : state) {
+        unchecked_vector<uint64_t> x;
+        epl::load(x, startup_binary);
+        benchmark::DoNotOptimize(x.data());
+    }
+    set_counters(state);
+}
+
+// opening alone is nearly free; the sum touches every page once
+static void BM_startup_mapped_view(benchmark::State& state) {
+    write_startup_files(state.range(0));
+    for (auto _ : state) {
+        epl::mapped_vector_view<uint64_t> view(startup_binary);
+        uint64_t sum = 0;
+        for (uint64_t v : view) { sum += v; }
+        benchmark::DoNotOptimize(sum);
+    }
+    set_counters(state);
+}
+
+/*****************************************************************************************/
+// Scanning one field: array of structs against soa_vector columns
+/*****************************************************************************************/
+namespace {
+    struct Order {
+        double price;
+        int64_t quantity;
+        int64_t id;
+        char symbol[40];
+    };
+
+    using order_columns = epl::soa_vector<double, int64_t, int64_t, std::array<char, 40>>;
+} //namespace
+
+// every 64-byte row is loaded to read its 8-byte price
+static void BM_scan_aos(benchmark::State& state) {
+    unchecked_vector<Order> x;
+    for (int64_t k = 0; k < state.range(0); ++k) { x.push_back(Order{ k * 0.25, k, k, {} }); }
+    for (auto _ : state) {
+        double sum = 0;
+        for (const Order& o : x) { sum += o.price; }
+        benchmark::DoNotOptimize(sum);
+    }
+    set_counters(state);
+}
+
+static void BM_scan_soa_column(benchmark::State& state) {
+    order_columns x;
+    for (int64_t k = 0; k < state.range(0); ++k) { x.emplace_back(k * 0.25, k, k, std::array<char, 40>()); }
+    for (auto _ : state) {
+        double sum = 0;
+        for (double p : x.column<0>()) { sum += p; }
+        benchmark::DoNotOptimize(sum);
+    }
+    set_counters(state);
+}
+
+// the same scan through proxy references; with NDEBUG the iterator checks compile away
+static void BM_scan_soa_rows(benchmark::State& state) {
+    order_columns x;
+    for (int64_t k = 0; k < state.range(0); ++k) { x.emplace_back(k * 0.25, k, k, std::array<char, 40>()); }
+    for (auto _ : state) {
+        double sum = 0;
+        for (auto row : x) { sum += std::get<0>(row); }
+        benchmark::DoNotOptimize(sum);
+    }
+    set_counters(state);
+}
+
+/*****************************************************************************************/
+// Handing one vector to many readers: deep copies against copy-on-write sharing
+/*****************************************************************************************/
+template <bool CopyOnWrite>
+static void BM_copy_to_readers(benchmark::State& state) {
+    const int readers = 32;
+    unchecked_vector<uint64_t> x;
+    x.set_copy_on_write(CopyOnWrite);
+    for (int64_t k = 0; k < state.range(0); ++k) { x.push_back(k); }
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        for (int r = 0; r < readers; ++r) {
+            const unchecked_vector<uint64_t> copy(x);
+            sum += copy.data()[r];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    set_counters(state);
+}
+
+/*****************************************************************************************/
+// Growth policies: throughput and the memory left unused once the pushes are done
+/*****************************************************************************************/
+// every FrontEvery-th element is pushed at the front; 0 appends only
+template <typename Growth, int FrontEvery>
+static void BM_growth_policy(benchmark::State& state) {
+    typedef epl::vector<uint64_t, epl::unchecked, std::allocator<uint64_t>, 0, Growth> C;
+    const uint64_t n = state.range(0);
+    uint64_t capacity = 0;
+    uint64_t reallocations = 0;
+    for (auto _ : state) {
+        C c;
+        reallocations = 0;
+        for (uint64_t k = 0; k < n; ++k) {
+            const uint64_t before = c.capacity();
+            if (FrontEvery != 0 && k % FrontEvery == 0) { c.push_front(k); } else { c.push_back(k); }
+            if (c.capacity() != before) { ++reallocations; }
+        }
+        capacity = c.capacity();
+        benchmark::DoNotOptimize(c.data());
+    }
+    set_counters(state);
+    state.counters["slack"] = (double) (capacity - n) / n;
+    state.counters["reallocations"] = (double) reallocations;
+}
+
+/*****************************************************************************************/
+// Sorted lookup tables: flat containers against the node-based std ones
+/*****************************************************************************************/
+namespace {
+    std::vector<uint64_t> random_keys(uint64_t n, uint64_t seed) {
+        std::vector<uint64_t> keys(n);
+        uint64_t x = seed;
+        for (uint64_t& k : keys) {
+            x = x * 6364136223846793005ull + 1442695040888963407ull;
+            k = x >> 16;
+        }
+        return keys;
+    }
+
+    template <typename S>
+    S build_set(const std::vector<uint64_t>& keys) { return S(keys.begin(), keys.end()); }
+
+    template <typename M>
+    M build_map(const std::vector<uint64_t>& keys) {
+        M m;
+        std::vector<std::pair<uint64_t, uint64_t>> pairs;
+        for (uint64_t k : keys) { pairs.emplace_back(k, k); }
+        m.insert(pairs.begin(), pairs.end());
+        return m;
+    }
+
+    template <>
+    epl::flat_map<uint64_t, uint64_t, std::less<uint64_t>, epl::unchecked> build_map(const std::vector<uint64_t>& keys) {
+        epl::flat_map<uint64_t, uint64_t, std::less<uint64_t>, epl::unchecked> m;
+        std::vector<std::pair<uint64_t, uint64_t>> pairs;
+        for (uint64_t k : keys) { pairs.emplace_back(k, k); }
+        m.insert_range(pairs.begin(), pairs.end());
+        return m;
+    }
+
+    using unchecked_flat_set = epl::flat_set<uint64_t, std::less<uint64_t>, epl::unchecked>;
+    using unchecked_flat_map = epl::flat_map<uint64_t, uint64_t, std::less<uint64_t>, epl::unchecked>;
+} //namespace
+
+// half of the probes hit
+template <typename S>
+static void BM_set_lookup(benchmark::State& state) {
+    const std::vector<uint64_t> keys = random_keys(state.range(0), 1);
+    const S s = build_set<S>(keys);
+    std::vector<uint64_t> probes = random_keys(state.range(0), 2);
+    for (uint64_t k = 0; k < probes.size(); k += 2) { probes[k] = keys[k]; }
+    for (auto _ : state) {
+        uint64_t found = 0;
+        for (uint64_t k : probes) { found += s.count(k); }
+        benchmark::DoNotOptimize(found);
+    }
+    set_counters(state);
+}
+
+template <typename M>
+static void BM_map_lookup(benchmark::State& state) {
+    const std::vector<uint64_t> keys = random_keys(state.range(0), 1);
+    const M m = build_map<M>(keys);
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        for (uint64_t k : keys) { sum += m.find(k)->second; }
+        benchmark::DoNotOptimize(sum);
+    }
+    set_counters(state);
+}
+
+template <typename S>
+static void BM_set_build(benchmark::State& state) {
+    const std::vector<uint64_t> keys = random_keys(state.range(0), 1);
+    for (auto _ : state) {
+        S s = build_set<S>(keys);
+        benchmark::DoNotOptimize(s.size());
+    }
+    set_counters(state);
+}
+
+template <typename M>
+static void BM_map_build(benchmark::State& state) {
+    const std::vector<uint64_t> keys = random_keys(state.range(0), 1);
+    for (auto _ : state) {
+        M m = build_map<M>(keys);
+        benchmark::DoNotOptimize(m.size());
+    }
+    set_counters(state);
+}
+
+/*****************************************************************************************/
+// Sorting: epl::sort (radix for arithmetic keys) against std::sort on std::vector
+/*****************************************************************************************/
+namespace {
+    template <typename T> T sort_value(uint64_t k);
+    template <> uint32_t sort_value<uint32_t>(uint64_t k) { return (uint32_t) ((k * 0x9E3779B97F4A7C15ull) >> 32); }
+    template <> uint64_t sort_value<uint64_t>(uint64_t k) { return k * 0x9E3779B97F4A7C15ull; }
+    template <> float sort_value<float>(uint64_t k) { return (float) (int32_t) ((k * 0x9E3779B97F4A7C15ull) >> 32) / 1024.0f; }
+    template <> std::string sort_value<std::string>(uint64_t k) { return std::to_string((k * 0x9E3779B97F4A7C15ull) >> 40); }
+} //namespace
+
+template <typename T>
+static void BM_std_sort(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    std::vector<T> x(n);
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (uint64_t k = 0; k < n; ++k) { x[k] = sort_value<T>(k); }
+        state.ResumeTiming();
+        std::sort(x.begin(), x.end());
+        benchmark::ClobberMemory();
+    }
+    set_counters(state);
+}
+
+// Threaded = true sorts on a pool of hardware_concurrency() threads
+template <typename T, bool Threaded>
+static void BM_epl_sort(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    epl::thread_pool pool(Threaded ? std::thread::hardware_concurrency() : 1);
+    unchecked_vector<T> x(n);
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (uint64_t k = 0; k < n; ++k) { x[k] = sort_value<T>(k); }
+        state.ResumeTiming();
+        if (Threaded) { epl::sort(pool, x); } else { epl::sort(x); }
+        benchmark::ClobberMemory();
+    }
+    set_counters(state);
+}
+
+/*****************************************************************************************/
+// Pipelines: a vector per map/filter/take step against one lazy pass
+/*****************************************************************************************/
+template <typename C>
+static void BM_pipeline_materialized(benchmark::State& state) {
+    C x;
+    for (int64_t k = 0; k < state.range(0); ++k) { x.push_back((double) k); }
+    const uint64_t limit = state.range(0) / 4;
+    for (auto _ : state) {
+        C scaled;
+        for (double v : x) { scaled.push_back(v * 1.5); }
+        C odd;
+        for (double v : scaled) { if ((int64_t) v % 2 == 1) { odd.push_back(v); } }
+        C first;
+        for (uint64_t k = 0; k < limit && k < odd.size(); ++k) { first.push_back(odd[k]); }
+        benchmark::DoNotOptimize(first.data());
+    }
+    set_counters(state);
+}
+
+template <typename C>
+static void BM_pipeline_lazy(benchmark::State& state) {
+    C x;
+    for (int64_t k = 0; k < state.range(0); ++k) { x.push_back((double) k); }
+    const uint64_t limit = state.range(0) / 4;
+    for (auto _ : state) {
+        C first;
+        epl::views::collect(x | epl::views::transform([](double v) { return v * 1.5; })
+                              | epl::views::filter([](double v) { return (int64_t) v % 2 == 1; })
+                              | epl::views::take(limit), first);
+        benchmark::DoNotOptimize(first.data());
+    }
+    set_counters(state);
+}
+
+/*****************************************************************************************/
+// Growth by relocation: memcpy of trivially relocatable elements against the
+// element-wise move and destroy loop
+/*****************************************************************************************/
+namespace {
+    // the same 64 bytes as Pod64, but with user-provided copy and move, so
+    // growth goes through the element-wise loop
+    struct Pod64Moved {
+        uint64_t words[8];
+
+        Pod64Moved(void) : words() {}
+        Pod64Moved(const Pod64Moved& that) { std::copy(that.words, that.words + 8, words); }
+        Pod64Moved(Pod64Moved&& that) noexcept { std::copy(that.words, that.words + 8, words); }
+        Pod64Moved& operator=(const Pod64Moved& that) { std::copy(that.words, that.words + 8, words); return *this; }
+    };
+
+    // as above, but declared trivially relocatable
+    struct Pod64Relocatable : Pod64Moved {};
+} //namespace
+
+namespace epl {
+    template <>
+    struct is_trivially_relocatable<Pod64Relocatable> : std::true_type {};
+} //namespace epl
+
+template <typename T>
+static void BM_relocating_growth(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    for (auto _ : state) {
+        unchecked_vector<T> c;
+        T v;
+        for (uint64_t k = 0; k < n; ++k) {
+            v.words[0] = k;
+            c.push_back(v);
+        }
+        benchmark::DoNotOptimize(c.data());
+    }
+    set_counters(state);
+}
+
+/*****************************************************************************************/
+// Short-lived vectors: the default heap against the arena and pool allocators
+/*****************************************************************************************/
+namespace {
+    struct heap_source {
+        typedef std::allocator<int> allocator;
+        allocator get(void) { return allocator(); }
+        void batch_done(void) {}
+    };
+
+    // everything a batch allocated goes back in one release()
+    struct arena_source {
+        epl::arena resource;
+        typedef epl::arena_allocator<int> allocator;
+        allocator get(void) { return allocator(resource); }
+        void batch_done(void) { resource.release(); }
+    };
+
+    struct pool_source {
+        epl::pool resource;
+        typedef epl::pool_allocator<int> allocator;
+        allocator get(void) { return allocator(resource); }
+        void batch_done(void) {}
+    };
+} //namespace
+
+// batches of state.range(0) vectors of 12 ints, each dropped right away
+template <typename Source>
+static void BM_short_lived_vectors(benchmark::State& state) {
+    Source source;
+    for (auto _ : state) {
+        for (int64_t k = 0; k < state.range(0); ++k) {
+            epl::vector<int, epl::unchecked, typename Source::allocator> v(source.get());
+            for (int j = 0; j < 12; ++j) { v.push_back(j); }
+            benchmark::DoNotOptimize(v.data());
+        }
+        source.batch_done();
+    }
+    set_counters(state);
+}
+
+/*****************************************************************************************/
+// Long-running FIFO: push_back + pop_front around a steady queue length
+/*****************************************************************************************/
+namespace {
+    struct Record32 {
+        uint64_t words[4];
+    };
+
+    template <typename C>
+    void capacity_counter(benchmark::State& state, const C& c) { state.counters["capacity"] = (double) c.capacity(); }
+    template <typename T>
+    void capacity_counter(benchmark::State&, const std::deque<T>&) {}
+} //namespace
+
+// state.range(0) elements stay queued; every iteration moves 1 << 16 through
+template <typename C>
+static void BM_queue_steady_state(benchmark::State& state) {
+    const uint64_t length = state.range(0);
+    const uint64_t moves = 1 << 16;
+    C c;
+    Record32 r = {};
+    for (uint64_t k = 0; k < length; ++k) { c.push_back(r); }
+    for (auto _ : state) {
+        for (uint64_t k = 0; k < moves; ++k) {
+            r.words[0] = k;
+            c.push_back(r);
+            c.pop_front();
+        }
+        benchmark::DoNotOptimize(&c.front());
+    }
+    state.SetItemsProcessed(state.iterations() * moves);
+    capacity_counter(state, c);
+}
+
+/*****************************************************************************************/
+// Very large vectors: growth through operator new against mmap and mremap
+/*****************************************************************************************/
+template <typename Alloc>
+static void BM_large_push_back(benchmark::State& state) {
+    const uint64_t n = state.range(0);
+    for (auto _ : state) {
+        epl::vector<float, epl::unchecked, Alloc> c;
+        for (uint64_t k = 0; k < n; ++k) { c.push_back((float) k); }
+        benchmark::DoNotOptimize(c.data());
+    }
+    set_counters(state);
+}
+
+/*****************************************************************************************/
+// Registration
+/*****************************************************************************************/
+#define EPL_BENCH_TYPE(bench, container, T, sizes) \
+    BENCHMARK_TEMPLATE(bench, container<T>)->Apply(sizes)
+
+#define EPL_BENCH_ALL_TYPES(bench, container) \
+    EPL_BENCH_TYPE(bench, container, int, int_sizes); \
+    EPL_BENCH_TYPE(bench, container, Pod64, int_sizes); \
+    EPL_BENCH_TYPE(bench, container, std::string, string_sizes)
+
+// back-only operations against std::vector and std::deque
+#define EPL_BENCH_BACK(bench) \
+    EPL_BENCH_ALL_TYPES(bench, unchecked_vector); \
+    EPL_BENCH_ALL_TYPES(bench, std::vector); \
+    EPL_BENCH_ALL_TYPES(bench, std::deque)
+
+// double-ended operations against std::deque
+#define EPL_BENCH_BOTH_ENDS(bench) \
+    EPL_BENCH_ALL_TYPES(bench, unchecked_vector); \
+    EPL_BENCH_ALL_TYPES(bench, std::deque)
+
+EPL_BENCH_BACK(BM_push_back);
+EPL_BENCH_BOTH_ENDS(BM_push_front);
+EPL_BENCH_BACK(BM_emplace_back);
+EPL_BENCH_BOTH_ENDS(BM_emplace_front);
+EPL_BENCH_BOTH_ENDS(BM_mixed_growth);
+EPL_BENCH_BACK(BM_pop_back);
+EPL_BENCH_BOTH_ENDS(BM_pop_front);
+EPL_BENCH_BACK(BM_index);
+EPL_BENCH_BACK(BM_iterate);
+EPL_BENCH_ALL_TYPES(BM_iterate, checked_vector);
+BENCHMARK_TEMPLATE(BM_iterate_write, unchecked_vector<uint64_t>)->Range(1 << 10, 1 << 24);
+BENCHMARK_TEMPLATE(BM_iterate_write, checked_vector<uint64_t>)->Range(1 << 10, 1 << 24);
+BENCHMARK_TEMPLATE(BM_iterate_write, std::vector<uint64_t>)->Range(1 << 10, 1 << 24);
+BENCHMARK_TEMPLATE(BM_sort_through_iterators, unchecked_vector<uint64_t>)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_sort_through_iterators, checked_vector<uint64_t>)->Range(1 << 10, 1 << 20);
+EPL_BENCH_BACK(BM_copy_construct);
+EPL_BENCH_BACK(BM_move_construct);
+
+#define EPL_BENCH_KERNEL(name) \
+    BENCHMARK_TEMPLATE(BM_scalar_##name, float)->Range(1 << 10, 1 << 24); \
+    BENCHMARK_TEMPLATE(BM_kernel_##name, float)->Range(1 << 10, 1 << 24); \
+    BENCHMARK_TEMPLATE(BM_scalar_##name, int32_t)->Range(1 << 10, 1 << 24); \
+    BENCHMARK_TEMPLATE(BM_kernel_##name, int32_t)->Range(1 << 10, 1 << 24); \
+    BENCHMARK_TEMPLATE(BM_scalar_##name, double)->Range(1 << 10, 1 << 24); \
+    BENCHMARK_TEMPLATE(BM_kernel_##name, double)->Range(1 << 10, 1 << 24)
+
+EPL_BENCH_KERNEL(sum);
+EPL_BENCH_KERNEL(dot);
+EPL_BENCH_KERNEL(min);
+EPL_BENCH_KERNEL(axpy);
+
+BENCHMARK(BM_parallel_for_each)->Apply(thread_counts);
+BENCHMARK(BM_parallel_transform)->Apply(thread_counts);
+BENCHMARK(BM_parallel_reduce)->Apply(thread_counts);
+BENCHMARK(BM_parallel_sort)->Apply(thread_counts);
+
+BENCHMARK(BM_spsc_queue)->Args({ 1 << 22, 1 })->Args({ 1 << 22, 64 })->UseRealTime();
+BENCHMARK(BM_mutex_vector_queue)->Arg(1 << 22)->UseRealTime();
+
+BENCHMARK(BM_concurrent_vector_push_back)->Apply(contention);
+BENCHMARK(BM_mutex_vector_push_back)->Apply(contention);
+
+BENCHMARK_TEMPLATE(BM_push_latency, unchecked_vector<Record>, true)->Arg(1 << 20)->Iterations(5);
+BENCHMARK_TEMPLATE(BM_push_latency, epl::chunked_vector<Record, epl::unchecked>, true)->Arg(1 << 20)->Iterations(5);
+BENCHMARK_TEMPLATE(BM_push_latency, unchecked_vector<Record>, false)->Arg(1 << 20)->Iterations(5);
+BENCHMARK_TEMPLATE(BM_push_latency, epl::chunked_vector<Record, epl::unchecked>, false)->Arg(1 << 20)->Iterations(5);
+
+BENCHMARK(BM_startup_parse_text)->Arg(1 << 24)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_startup_load)->Arg(1 << 24)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_startup_mapped_view)->Arg(1 << 24)->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_scan_aos)->Range(1 << 10, 1 << 24);
+BENCHMARK(BM_scan_soa_column)->Range(1 << 10, 1 << 24);
+BENCHMARK(BM_scan_soa_rows)->Range(1 << 10, 1 << 24);
+
+BENCHMARK_TEMPLATE(BM_copy_to_readers, false)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_copy_to_readers, true)->Range(1 << 10, 1 << 20);
+
+BENCHMARK_TEMPLATE(BM_growth_policy, epl::double_growth, 0)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_growth_policy, epl::one_and_half_growth, 0)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_growth_policy, epl::size_class_growth<>, 0)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_growth_policy, epl::adaptive_split<>, 0)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_growth_policy, epl::double_growth, 2)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_growth_policy, epl::adaptive_split<>, 2)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_growth_policy, epl::adaptive_split<>, 8)->Range(1 << 10, 1 << 22);
+
+BENCHMARK_TEMPLATE(BM_set_lookup, unchecked_flat_set)->Range(1 << 6, 1 << 20);
+BENCHMARK_TEMPLATE(BM_set_lookup, std::set<uint64_t>)->Range(1 << 6, 1 << 20);
+BENCHMARK_TEMPLATE(BM_map_lookup, unchecked_flat_map)->Range(1 << 6, 1 << 20);
+BENCHMARK_TEMPLATE(BM_map_lookup, std::map<uint64_t, uint64_t>)->Range(1 << 6, 1 << 20);
+BENCHMARK_TEMPLATE(BM_set_build, unchecked_flat_set)->Range(1 << 6, 1 << 20);
+BENCHMARK_TEMPLATE(BM_set_build, std::set<uint64_t>)->Range(1 << 6, 1 << 20);
+BENCHMARK_TEMPLATE(BM_map_build, unchecked_flat_map)->Range(1 << 6, 1 << 20);
+BENCHMARK_TEMPLATE(BM_map_build, std::map<uint64_t, uint64_t>)->Range(1 << 6, 1 << 20);
+
+BENCHMARK_TEMPLATE(BM_std_sort, uint32_t)->Range(1 << 10, 1 << 24);
+BENCHMARK_TEMPLATE(BM_epl_sort, uint32_t, false)->Range(1 << 10, 1 << 24);
+BENCHMARK_TEMPLATE(BM_epl_sort, uint32_t, true)->Range(1 << 16, 1 << 24)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_std_sort, uint64_t)->Range(1 << 10, 1 << 24);
+BENCHMARK_TEMPLATE(BM_epl_sort, uint64_t, false)->Range(1 << 10, 1 << 24);
+BENCHMARK_TEMPLATE(BM_epl_sort, uint64_t, true)->Range(1 << 16, 1 << 24)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_std_sort, float)->Range(1 << 10, 1 << 24);
+BENCHMARK_TEMPLATE(BM_epl_sort, float, false)->Range(1 << 10, 1 << 24);
+BENCHMARK_TEMPLATE(BM_epl_sort, float, true)->Range(1 << 16, 1 << 24)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_std_sort, std::string)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_epl_sort, std::string, false)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_epl_sort, std::string, true)->Range(1 << 16, 1 << 20)->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_pipeline_materialized, unchecked_vector<double>)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_pipeline_lazy, unchecked_vector<double>)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_pipeline_materialized, checked_vector<double>)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_pipeline_lazy, checked_vector<double>)->Range(1 << 10, 1 << 22);
+
+BENCHMARK_TEMPLATE(BM_relocating_growth, Pod64)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_relocating_growth, Pod64Moved)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_relocating_growth, Pod64Relocatable)->Range(1 << 10, 1 << 22);
+
+BENCHMARK_TEMPLATE(BM_short_lived_vectors, heap_source)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_short_lived_vectors, arena_source)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_short_lived_vectors, pool_source)->Arg(1000);
+
+BENCHMARK_TEMPLATE(BM_queue_steady_state, unchecked_vector<Record32>)->Arg(1000)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_queue_steady_state, std::deque<Record32>)->Arg(1000)->Arg(1 << 16);
+
+BENCHMARK_TEMPLATE(BM_large_push_back, std::allocator<float>)->Arg(1 << 24)->Arg(1 << 27)->Unit(benchmark::kMillisecond)->Iterations(3);
+BENCHMARK_TEMPLATE(BM_large_push_back, epl::mmap_allocator<float>)->Arg(1 << 24)->Arg(1 << 27)->Unit(benchmark::kMillisecond)->Iterations(3);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,515 @@
+#ifndef _VIEWS_H_
+#define _VIEWS_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "Vector.h"
+
+// Lazy views over epl::vector ranges.  A pipeline such as
+//
+//     auto big = v | views::transform(price) | views::filter(over_limit) | views::take(10);
+//     epl::vector<double> out = views::to_vector(big);
+//
+// builds no intermediate vectors: each element flows through every stage
+// when the sink (or any loop over the view) reaches it.
+//
+// The source of a pipeline is a pair of vector iterators.  Its begin() and
+// end() turn them into raw element pointers with detail::to_address, so a
+// checked iterator is validated each time a pipeline is started (a
+// boundary) and the stages then step over pointers, with no check per
+// element per stage.  As with the Parallel.h algorithms the source must not
+// be resized while a pipeline is being iterated.  Views store the functions
+// they are given and their upstream views by value; iterators point into
+// their view, so a view must outlive its iterators.
+//
+// Views know their size() when it can be had without iterating (no filter
+// upstream), and the sinks use it to reserve once.
+
+namespace epl{
+    
+    namespace views {
+        
+        // marks the view types, which are passed and stored by value
+        struct view_base {};
+        
+        template <typename R>
+        using is_view = std::is_base_of<view_base, typename std::decay<R>::type>;
+        
+        template <typename V>
+        using iterator_of = decltype(std::declval<const V&>().begin());
+        
+        namespace detail {
+            template <typename...>
+            struct voider { typedef void type; };
+            
+            template <typename V, typename = void>
+            struct has_size : std::false_type {};
+            
+            template <typename V>
+            struct has_size<V, typename voider<decltype(std::declval<const V&>().size())>::type> : std::true_type {};
+            
+            template <typename C, typename = void>
+            struct has_reserve : std::false_type {};
+            
+            template <typename C>
+            struct has_reserve<C, typename voider<decltype(std::declval<C&>().reserve(0))>::type> : std::true_type {};
+        }
+        
+        // [first, last) of any iterator type; chunk yields these
+        template <typename Iterator>
+        class subrange : public view_base {
+            Iterator first;
+            Iterator last;
+        
+        public:
+            subrange(Iterator first, Iterator last) : first(first), last(last) {}
+            
+            Iterator begin(void) const { return first; }
+            Iterator end(void) const { return last; }
+            
+            template <typename I = Iterator>
+            auto size(void) const -> decltype(uint64_t(std::declval<I>() - std::declval<I>())) { return last - first; }
+        };
+        
+        // the head of a pipeline: vector iterators, read as pointers
+        template <typename Iterator>
+        class source_view : public view_base {
+            static_assert(epl::detail::is_contiguous_iterator<Iterator>::value, "a pipeline source needs pointers or vector iterators");
+            
+            Iterator first;
+            Iterator last;
+        
+        public:
+            using pointer = decltype(epl::detail::to_address(std::declval<const Iterator&>()));
+            
+            source_view(Iterator first, Iterator last) : first(first), last(last) {}
+            
+            pointer begin(void) const { return epl::detail::to_address(first); }
+            pointer end(void) const { return begin() + size(); }
+            uint64_t size(void) const { return last - first; }
+        };
+        
+        template <typename Iterator>
+        source_view<Iterator> all(Iterator first, Iterator last) {
+            return source_view<Iterator>(first, last);
+        }
+        
+        // a view stays a view; anything else with begin()/end(), such as an
+        // epl::vector, is read through its iterators and must outlive the view
+        template <typename R, typename std::enable_if<is_view<R>::value, int>::type = 0>
+        typename std::decay<R>::type all(R&& r) {
+            return std::forward<R>(r);
+        }
+        
+        template <typename R, typename std::enable_if<!is_view<R>::value, int>::type = 0>
+        auto all(R& r) -> source_view<decltype(r.begin())> {
+            return source_view<decltype(r.begin())>(r.begin(), r.end());
+        }
+        
+        template <typename R>
+        using all_t = decltype(all(std::declval<R>()));
+        
+        /*****************************************************************************************/
+        // transform
+        /*****************************************************************************************/
+        template <typename V, typename F>
+        class transform_view : public view_base {
+            V base;
+            F f;
+        
+        public:
+            class iterator {
+                iterator_of<V> it;
+                const F* f;
+            
+            public:
+                using iterator_category = typename std::conditional<
+                    std::is_base_of<std::bidirectional_iterator_tag, typename std::iterator_traits<iterator_of<V>>::iterator_category>::value,
+                    std::bidirectional_iterator_tag, std::forward_iterator_tag>::type;
+                using reference = decltype((*f)(*it));
+                using value_type = typename std::decay<reference>::type;
+                using difference_type = std::ptrdiff_t;
+                using pointer = void;
+                
+                iterator(void) : it(), f(nullptr) {}
+                iterator(iterator_of<V> it, const F* f) : it(it), f(f) {}
+                
+                reference operator*(void) const { return (*f)(*it); }
+                iterator& operator++(void) { ++it; return *this; }
+                iterator operator++(int) { iterator tmp(*this); ++it; return tmp; }
+                iterator& operator--(void) { --it; return *this; }
+                iterator operator--(int) { iterator tmp(*this); --it; return tmp; }
+                bool operator==(const iterator& that) const { return it == that.it; }
+                bool operator!=(const iterator& that) const { return it != that.it; }
+            };
+            
+            transform_view(V base, F f) : base(std::move(base)), f(std::move(f)) {}
+            
+            iterator begin(void) const { return iterator(base.begin(), &f); }
+            iterator end(void) const { return iterator(base.end(), &f); }
+            
+            template <typename B = V, typename = typename std::enable_if<detail::has_size<B>::value>::type>
+            uint64_t size(void) const { return base.size(); }
+        };
+        
+        /*****************************************************************************************/
+        // filter
+        /*****************************************************************************************/
+        template <typename V, typename P>
+        class filter_view : public view_base {
+            V base;
+            P pred;
+        
+        public:
+            class iterator {
+                iterator_of<V> it;
+                iterator_of<V> last;
+                const P* pred;
+                
+                void skip(void) { while (it != last && !(*pred)(*it)) { ++it; } }
+            
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using reference = typename std::iterator_traits<iterator_of<V>>::reference;
+                using value_type = typename std::iterator_traits<iterator_of<V>>::value_type;
+                using difference_type = std::ptrdiff_t;
+                using pointer = void;
+                
+                iterator(void) : it(), last(), pred(nullptr) {}
+                iterator(iterator_of<V> it, iterator_of<V> last, const P* pred) : it(it), last(last), pred(pred) { skip(); }
+                
+                reference operator*(void) const { return *it; }
+                iterator& operator++(void) { ++it; skip(); return *this; }
+                iterator operator++(int) { iterator tmp(*this); ++*this; return tmp; }
+                bool operator==(const iterator& that) const { return it == that.it; }
+                bool operator!=(const iterator& that) const { return it != that.it; }
+            };
+            
+            filter_view(V base, P pred) : base(std::move(base)), pred(std::move(pred)) {}
+            
+            iterator begin(void) const { return iterator(base.begin(), base.end(), &pred); }
+            iterator end(void) const { return iterator(base.end(), base.end(), &pred); }
+        };
+        
+        /*****************************************************************************************/
+        // take and drop
+        /*****************************************************************************************/
+        template <typename V>
+        class take_view : public view_base {
+            V base;
+            uint64_t count;
+        
+        public:
+            // equal once either the count or the underlying range runs out
+            class iterator {
+                iterator_of<V> it;
+                iterator_of<V> last;
+                uint64_t remaining;
+                
+                bool done(void) const { return remaining == 0 || it == last; }
+            
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using reference = typename std::iterator_traits<iterator_of<V>>::reference;
+                using value_type = typename std::iterator_traits<iterator_of<V>>::value_type;
+                using difference_type = std::ptrdiff_t;
+                using pointer = void;
+                
+                iterator(void) : it(), last(), remaining(0) {}
+                iterator(iterator_of<V> it, iterator_of<V> last, uint64_t remaining) : it(it), last(last), remaining(remaining) {}
+                
+                reference operator*(void) const { return *it; }
+                iterator& operator++(void) { ++it; --remaining; return *this; }
+                iterator operator++(int) { iterator tmp(*this); ++*this; return tmp; }
+                
+                bool operator==(const iterator& that) const {
+                    return done() == that.done() && (done() || it == that.it);
+                }
+                
+                bool operator!=(const iterator& that) const { return !(*this == that); }
+            };
+            
+            take_view(V base, uint64_t count) : base(std::move(base)), count(count) {}
+            
+            iterator begin(void) const { return iterator(base.begin(), base.end(), count); }
+            iterator end(void) const { return iterator(base.end(), base.end(), 0); }
+            
+            template <typename B = V, typename = typename std::enable_if<detail::has_size<B>::value>::type>
+            uint64_t size(void) const { return std::min<uint64_t>(count, base.size()); }
+        };
+        
+        // skips the first count elements; finding them costs a walk over
+        // them unless the upstream iterators are random access
+        template <typename V>
+        class drop_view : public view_base {
+            V base;
+            uint64_t count;
+        
+        public:
+            using iterator = iterator_of<V>;
+            
+            drop_view(V base, uint64_t count) : base(std::move(base)), count(count) {}
+            
+            iterator begin(void) const {
+                return advance(base.begin(), base.end(), typename std::iterator_traits<iterator>::iterator_category());
+            }
+            
+            iterator end(void) const { return base.end(); }
+            
+            template <typename B = V, typename = typename std::enable_if<detail::has_size<B>::value>::type>
+            uint64_t size(void) const { return base.size() - std::min<uint64_t>(count, base.size()); }
+        
+        private:
+            iterator advance(iterator it, iterator last, std::random_access_iterator_tag) const {
+                return it + std::min<uint64_t>(count, last - it);
+            }
+            
+            iterator advance(iterator it, iterator last, std::input_iterator_tag) const {
+                for (uint64_t k = 0; k < count && it != last; ++k) { ++it; }
+                return it;
+            }
+        };
+        
+        /*****************************************************************************************/
+        // reverse
+        /*****************************************************************************************/
+        template <typename V>
+        class reverse_view : public view_base {
+            V base;
+        
+        public:
+            using iterator = std::reverse_iterator<iterator_of<V>>;
+            
+            explicit reverse_view(V base) : base(std::move(base)) {}
+            
+            iterator begin(void) const { return iterator(base.end()); }
+            iterator end(void) const { return iterator(base.begin()); }
+            
+            template <typename B = V, typename = typename std::enable_if<detail::has_size<B>::value>::type>
+            uint64_t size(void) const { return base.size(); }
+        };
+        
+        /*****************************************************************************************/
+        // chunk
+        /*****************************************************************************************/
+        // consecutive subranges of n elements, the last one possibly shorter
+        template <typename V>
+        class chunk_view : public view_base {
+            V base;
+            uint64_t n;
+        
+        public:
+            class iterator {
+                iterator_of<V> it;
+                iterator_of<V> next;
+                iterator_of<V> last;
+                uint64_t n;
+                
+                void find_next(void) {
+                    next = it;
+                    for (uint64_t k = 0; k < n && next != last; ++k) { ++next; }
+                }
+            
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = subrange<iterator_of<V>>;
+                using reference = value_type;
+                using difference_type = std::ptrdiff_t;
+                using pointer = void;
+                
+                iterator(void) : it(), next(), last(), n(0) {}
+                iterator(iterator_of<V> it, iterator_of<V> last, uint64_t n) : it(it), next(it), last(last), n(n) { find_next(); }
+                
+                value_type operator*(void) const { return value_type(it, next); }
+                iterator& operator++(void) { it = next; find_next(); return *this; }
+                iterator operator++(int) { iterator tmp(*this); ++*this; return tmp; }
+                bool operator==(const iterator& that) const { return it == that.it; }
+                bool operator!=(const iterator& that) const { return it != that.it; }
+            };
+            
+            chunk_view(V base, uint64_t n) : base(std::move(base)), n(n) {
+                if (n == 0) { throw std::invalid_argument("chunk size must be positive"); }
+            }
+            
+            iterator begin(void) const { return iterator(base.begin(), base.end(), n); }
+            iterator end(void) const { return iterator(base.end(), base.end(), n); }
+            
+            template <typename B = V, typename = typename std::enable_if<detail::has_size<B>::value>::type>
+            uint64_t size(void) const { return (base.size() + n - 1) / n; }
+        };
+        
+        /*****************************************************************************************/
+        // zip
+        /*****************************************************************************************/
+        // pairs of elements, ending with the shorter view
+        template <typename V1, typename V2>
+        class zip_view : public view_base {
+            V1 first;
+            V2 second;
+        
+        public:
+            class iterator {
+                iterator_of<V1> a;
+                iterator_of<V2> b;
+                iterator_of<V1> a_last;
+                iterator_of<V2> b_last;
+                
+                bool done(void) const { return a == a_last || b == b_last; }
+            
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using reference = std::pair<typename std::iterator_traits<iterator_of<V1>>::reference,
+                                            typename std::iterator_traits<iterator_of<V2>>::reference>;
+                using value_type = std::pair<typename std::iterator_traits<iterator_of<V1>>::value_type,
+                                             typename std::iterator_traits<iterator_of<V2>>::value_type>;
+                using difference_type = std::ptrdiff_t;
+                using pointer = void;
+                
+                iterator(void) : a(), b(), a_last(), b_last() {}
+                iterator(iterator_of<V1> a, iterator_of<V2> b, iterator_of<V1> a_last, iterator_of<V2> b_last) :
+                a(a), b(b), a_last(a_last), b_last(b_last) {}
+                
+                reference operator*(void) const { return reference(*a, *b); }
+                iterator& operator++(void) { ++a; ++b; return *this; }
+                iterator operator++(int) { iterator tmp(*this); ++*this; return tmp; }
+                
+                bool operator==(const iterator& that) const {
+                    return done() == that.done() && (done() || (a == that.a && b == that.b));
+                }
+                
+                bool operator!=(const iterator& that) const { return !(*this == that); }
+            };
+            
+            zip_view(V1 first, V2 second) : first(std::move(first)), second(std::move(second)) {}
+            
+            iterator begin(void) const { return iterator(first.begin(), second.begin(), first.end(), second.end()); }
+            iterator end(void) const { return iterator(first.end(), second.end(), first.end(), second.end()); }
+            
+            template <typename B1 = V1, typename B2 = V2,
+                      typename = typename std::enable_if<detail::has_size<B1>::value && detail::has_size<B2>::value>::type>
+            uint64_t size(void) const { return std::min<uint64_t>(first.size(), second.size()); }
+        };
+        
+        /*****************************************************************************************/
+        // Construction: views::transform(r, f) or r | views::transform(f)
+        /*****************************************************************************************/
+        // a view waiting for its range on the left of |
+        template <typename Make>
+        struct adaptor {
+            Make make;
+        };
+        
+        template <typename Make>
+        adaptor<Make> make_adaptor(Make make) {
+            return adaptor<Make>{ std::move(make) };
+        }
+        
+        template <typename R, typename Make>
+        auto operator|(R&& r, const adaptor<Make>& a) -> decltype(a.make(all(std::forward<R>(r)))) {
+            return a.make(all(std::forward<R>(r)));
+        }
+        
+        template <typename R, typename F>
+        transform_view<all_t<R>, F> transform(R&& r, F f) {
+            return transform_view<all_t<R>, F>(all(std::forward<R>(r)), std::move(f));
+        }
+        
+        template <typename F>
+        auto transform(F f) {
+            return make_adaptor([f](auto v) { return transform_view<decltype(v), F>(std::move(v), f); });
+        }
+        
+        template <typename R, typename P>
+        filter_view<all_t<R>, P> filter(R&& r, P pred) {
+            return filter_view<all_t<R>, P>(all(std::forward<R>(r)), std::move(pred));
+        }
+        
+        template <typename P>
+        auto filter(P pred) {
+            return make_adaptor([pred](auto v) { return filter_view<decltype(v), P>(std::move(v), pred); });
+        }
+        
+        template <typename R>
+        take_view<all_t<R>> take(R&& r, uint64_t n) {
+            return take_view<all_t<R>>(all(std::forward<R>(r)), n);
+        }
+        
+        inline auto take(uint64_t n) {
+            return make_adaptor([n](auto v) { return take_view<decltype(v)>(std::move(v), n); });
+        }
+        
+        template <typename R>
+        drop_view<all_t<R>> drop(R&& r, uint64_t n) {
+            return drop_view<all_t<R>>(all(std::forward<R>(r)), n);
+        }
+        
+        inline auto drop(uint64_t n) {
+            return make_adaptor([n](auto v) { return drop_view<decltype(v)>(std::move(v), n); });
+        }
+        
+        template <typename R>
+        reverse_view<all_t<R>> reverse(R&& r) {
+            return reverse_view<all_t<R>>(all(std::forward<R>(r)));
+        }
+        
+        inline auto reverse(void) {
+            return make_adaptor([](auto v) { return reverse_view<decltype(v)>(std::move(v)); });
+        }
+        
+        template <typename R>
+        chunk_view<all_t<R>> chunk(R&& r, uint64_t n) {
+            return chunk_view<all_t<R>>(all(std::forward<R>(r)), n);
+        }
+        
+        inline auto chunk(uint64_t n) {
+            return make_adaptor([n](auto v) { return chunk_view<decltype(v)>(std::move(v), n); });
+        }
+        
+        template <typename R1, typename R2>
+        zip_view<all_t<R1>, all_t<R2>> zip(R1&& r1, R2&& r2) {
+            return zip_view<all_t<R1>, all_t<R2>>(all(std::forward<R1>(r1)), all(std::forward<R2>(r2)));
+        }
+        
+        /*****************************************************************************************/
+        // Sinks
+        /*****************************************************************************************/
+        namespace detail {
+            template <typename V, typename Dest>
+            void reserve_for(const V& v, Dest& dest, std::true_type) {
+                dest.reserve(dest.size() + v.size());
+            }
+            
+            template <typename V, typename Dest>
+            void reserve_for(const V&, Dest&, std::false_type) {}
+        }
+        
+        // Appends every element of the view to dest (anything with
+        // push_back) in one pass, reserving room for them first when the
+        // view knows its size and dest can reserve.
+        template <typename R, typename Dest>
+        Dest& collect(R&& r, Dest& dest) {
+            auto v = all(std::forward<R>(r));
+            detail::reserve_for(v, dest, std::integral_constant<bool, detail::has_size<decltype(v)>::value && detail::has_reserve<Dest>::value>());
+            auto last = v.end();
+            for (auto it = v.begin(); it != last; ++it) { dest.push_back(*it); }
+            return dest;
+        }
+        
+        template <typename R>
+        auto to_vector(R&& r) {
+            using V = all_t<R>;
+            vector<typename std::decay<typename std::iterator_traits<iterator_of<V>>::value_type>::type> dest;
+            collect(std::forward<R>(r), dest);
+            return dest;
+        }
+    }
+    
+} //namespace epl
+
+#endif